@@ -0,0 +1,345 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Bit-sliced (transposed) Bloom filters for "which of N sets contain this
+// key", as when routing keys to shards. Instead of N filters of m bits,
+// store m rows of N bits: bit s of row p is bit p of shard s's filter. One
+// set of k worm64 positions from the key's hash selects k rows, and ANDing
+// them (with SIMD where available) gives the bitmap of candidate shards in
+// one pass. Rows are 8, 16 or 32 bits (several packed per 64-bit word)
+// for up to 32 shards, otherwise whole 64-bit words, so the index is no
+// larger than the per-shard filters except for rounding N up to those
+// widths. For comparison, the same filters are also stored one per
+// shard and probed in a loop over shards (sharing the positions), and the
+// two bitmaps are checked to be identical.
+//
+// Usage: bit_sliced.out NUM_SHARDS KEYS_PER_SHARD BITS_PER_KEY K NUM_QUERIES
+//                       [seed=1] [positive=0.0]
+//
+// positive= is the fraction of queries for keys that were added (to one
+// shard each).
+
+#define XXH_INLINE_ALL
+#include "../third-party/xxHash/xxhash.h"
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+static inline uint64_t hash(uint64_t v, uint64_t seed) {
+  return XXH64(&v, sizeof(v), seed);
+}
+
+static inline uint64_t worm64(uint64_t a, uint64_t &h) {
+  __uint128_t wide = (__uint128_t)a * h;
+  h = (uint64_t)wide;
+  return (uint64_t)(wide >> 64);
+}
+
+static const unsigned kMaxK = 64;
+
+static int opt_argc = 0;
+static char **opt_argv = nullptr;
+
+static const char *get_opt(const char *name, const char *default_value) {
+  size_t len = strlen(name);
+  for (int i = 6; i < opt_argc; ++i) {
+    if (strncmp(opt_argv[i], name, len) == 0 && opt_argv[i][len] == '=') {
+      return opt_argv[i] + len + 1;
+    }
+  }
+  return default_value;
+}
+
+// 64-byte aligned, zeroed array of words
+static uint64_t *alloc_words(size_t words, std::unique_ptr<uint64_t[]> &owner) {
+  owner.reset(new uint64_t[words + 7]);
+  uint64_t *p = owner.get();
+  while ((uintptr_t)p & 63) { ++p; }
+  std::fill(p, p + words, 0);
+  return p;
+}
+
+struct BitSliced {
+  unsigned shards;
+  unsigned k;
+  uint64_t m_odd;      // positions (rows) used
+  unsigned row_bits;   // 8, 16 or 32 (packed), else row_words * 64
+  size_t row_words;    // stride for row_bits >= 64
+  uint64_t *rows;
+  std::unique_ptr<uint64_t[]> mem;
+
+  void init(unsigned num_shards, uint64_t m, unsigned num_k) {
+    shards = num_shards;
+    k = num_k;
+    m_odd = m - (~m & 1);
+    row_bits = 8;
+    while (row_bits < num_shards && row_bits < 64) {
+      row_bits *= 2;
+    }
+    row_words = (num_shards + 63) / 64;
+    if (row_bits >= 64) {
+      row_bits = (unsigned)row_words * 64;
+    }
+    rows = alloc_words(words(), mem);
+  }
+
+  size_t words() const {
+    return (size_t)((m_odd * row_bits + 63) / 64);
+  }
+
+  void positions(uint64_t h, uint64_t *pos) const {
+    for (unsigned i = 0; i < k; ++i) {
+      pos[i] = worm64(m_odd, /*in/out*/h);
+    }
+  }
+
+  void add(unsigned shard, uint64_t h) {
+    for (unsigned i = 0; i < k; ++i) {
+      uint64_t bit = worm64(m_odd, /*in/out*/h) * row_bits + shard;
+      rows[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    }
+  }
+
+  // Bitmap of candidate shards for h into out[0..row_words)
+  void query(uint64_t h, uint64_t *out) const {
+    uint64_t pos[kMaxK];
+    positions(h, pos);
+    if (row_bits < 64) {
+      for (unsigned i = 0; i < k; ++i) {
+        __builtin_prefetch(rows + ((pos[i] * row_bits) >> 6), 0, 3);
+      }
+      uint64_t acc = ~(uint64_t)0;
+      for (unsigned i = 0; i < k; ++i) {
+        uint64_t bit = pos[i] * row_bits;
+        acc &= rows[bit >> 6] >> (bit & 63);
+      }
+      out[0] = acc & (((uint64_t)1 << row_bits) - 1);
+      return;
+    }
+    for (unsigned i = 0; i < k; ++i) {
+      __builtin_prefetch(rows + pos[i] * row_words, 0, 3);
+    }
+    const uint64_t *row = rows + pos[0] * row_words;
+    size_t w = 0;
+#if defined(__AVX2__)
+    // Rows are not padded to the vector width, so unaligned loads over
+    // whole groups of 4 words, then a scalar tail
+    for (; w + 4 <= row_words; w += 4) {
+      __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + w));
+      for (unsigned i = 1; i < k; ++i) {
+        acc = _mm256_and_si256(acc, _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(rows + pos[i] * row_words + w)));
+      }
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + w), acc);
+    }
+#endif
+    for (; w < row_words; ++w) {
+      uint64_t acc = row[w];
+      for (unsigned i = 1; i < k; ++i) {
+        acc &= rows[pos[i] * row_words + w];
+      }
+      out[w] = acc;
+    }
+  }
+};
+
+// The same filters, one contiguous m-bit filter per shard
+struct PerShard {
+  unsigned shards;
+  unsigned k;
+  uint64_t m_odd;
+  size_t filter_words;
+  uint64_t *filters;
+  std::unique_ptr<uint64_t[]> mem;
+
+  void init(unsigned num_shards, uint64_t m, unsigned num_k) {
+    shards = num_shards;
+    k = num_k;
+    m_odd = m - (~m & 1);
+    filter_words = (m_odd + 63) / 64;
+    filters = alloc_words(filter_words * num_shards, mem);
+  }
+
+  void add(unsigned shard, uint64_t h) {
+    uint64_t *f = filters + shard * filter_words;
+    for (unsigned i = 0; i < k; ++i) {
+      uint64_t p = worm64(m_odd, /*in/out*/h);
+      f[p >> 6] |= (uint64_t)1 << (p & 63);
+    }
+  }
+
+  // Probe each shard's filter in turn (positions computed once)
+  void query(uint64_t h, uint64_t *out, size_t out_words) const {
+    uint64_t pos[kMaxK];
+    for (unsigned i = 0; i < k; ++i) {
+      pos[i] = worm64(m_odd, /*in/out*/h);
+    }
+    std::fill(out, out + out_words, 0);
+    for (unsigned s = 0; s < shards; ++s) {
+      const uint64_t *f = filters + s * filter_words;
+      unsigned i = 0;
+      for (; i < k; ++i) {
+        if ((f[pos[i] >> 6] & ((uint64_t)1 << (pos[i] & 63))) == 0) {
+          break;
+        }
+      }
+      if (i == k) {
+        out[s >> 6] |= (uint64_t)1 << (s & 63);
+      }
+    }
+  }
+};
+
+int main(int argc, char *argv[]) {
+  if (argc < 6) {
+    std::cerr << "Usage: " << argv[0]
+      << " NUM_SHARDS KEYS_PER_SHARD BITS_PER_KEY K NUM_QUERIES"
+         " [seed=1] [positive=0.0]" << std::endl;
+    return 2;
+  }
+  opt_argc = argc;
+  opt_argv = argv;
+  unsigned shards = (unsigned)std::atoi(argv[1]);
+  uint64_t keys_per_shard = std::strtoull(argv[2], nullptr, 10);
+  double bits_per_key = std::atof(argv[3]);
+  unsigned k = (unsigned)std::atoi(argv[4]);
+  uint64_t num_queries = std::strtoull(argv[5], nullptr, 10);
+  uint64_t seed = std::strtoull(get_opt("seed", "1"), nullptr, 10);
+  double positive = std::atof(get_opt("positive", "0"));
+  if (shards < 1 || keys_per_shard < 1 || k < 1 || k > kMaxK ||
+      bits_per_key <= 0) {
+    std::cerr << "Need NUM_SHARDS, KEYS_PER_SHARD >= 1, 1 <= K <= " << kMaxK
+              << " and BITS_PER_KEY > 0" << std::endl;
+    return 2;
+  }
+  uint64_t m = std::max((uint64_t)2,
+                        (uint64_t)std::ceil(keys_per_shard * bits_per_key));
+
+  BitSliced sliced;
+  sliced.init(shards, m, k);
+  PerShard per_shard;
+  per_shard.init(shards, m, k);
+
+  // Key i of shard s is (s << 32) + i
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (unsigned s = 0; s < shards; ++s) {
+    for (uint64_t i = 0; i < keys_per_shard; ++i) {
+      sliced.add(s, hash(((uint64_t)s << 32) + i, seed));
+    }
+  }
+  std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+  for (unsigned s = 0; s < shards; ++s) {
+    for (uint64_t i = 0; i < keys_per_shard; ++i) {
+      per_shard.add(s, hash(((uint64_t)s << 32) + i, seed));
+    }
+  }
+  std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+  double sliced_add_secs = std::chrono::duration<double>(t1 - t0).count();
+  double per_shard_add_secs = std::chrono::duration<double>(t2 - t1).count();
+
+  // Queries in chunks, generated outside the timed regions
+  const size_t kChunk = 16384;
+  size_t out_words = sliced.row_words;
+  std::vector<uint64_t> hs(kChunk);
+  std::vector<int> true_shard(kChunk);
+  std::unique_ptr<uint64_t[]> out_mem;
+  uint64_t *out = alloc_words(kChunk * out_words, out_mem);
+  std::unique_ptr<uint64_t[]> ref_mem;
+  uint64_t *ref = alloc_words(kChunk * out_words, ref_mem);
+  std::mt19937_64 rng(seed ^ 0x9e3779b97f4a7c15);
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+  double sliced_secs = 0, per_shard_secs = 0;
+  uint64_t candidates = 0, positives = 0, missed = 0, mismatches = 0;
+  for (uint64_t done = 0; done < num_queries;) {
+    size_t n = (size_t)std::min<uint64_t>(kChunk, num_queries - done);
+    for (size_t i = 0; i < n; ++i) {
+      if (coin(rng) < positive) {
+        unsigned s = (unsigned)(rng() % shards);
+        true_shard[i] = (int)s;
+        hs[i] = hash(((uint64_t)s << 32) + rng() % keys_per_shard, seed);
+      } else {
+        true_shard[i] = -1;
+        // Shard index field beyond any real shard
+        hs[i] = hash(((uint64_t)0xffffffff << 32) | (rng() >> 32), seed);
+      }
+    }
+    std::chrono::steady_clock::time_point q0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+      sliced.query(hs[i], out + i * out_words);
+    }
+    std::chrono::steady_clock::time_point q1 = std::chrono::steady_clock::now();
+    sliced_secs += std::chrono::duration<double>(q1 - q0).count();
+    for (size_t i = 0; i < n; ++i) {
+      per_shard.query(hs[i], ref + i * out_words, out_words);
+    }
+    std::chrono::steady_clock::time_point q2 = std::chrono::steady_clock::now();
+    per_shard_secs += std::chrono::duration<double>(q2 - q1).count();
+    for (size_t i = 0; i < n; ++i) {
+      const uint64_t *bits = out + i * out_words;
+      mismatches += !std::equal(bits, bits + out_words, ref + i * out_words);
+      for (size_t w = 0; w < out_words; ++w) {
+        candidates += __builtin_popcountll(bits[w]);
+      }
+      if (true_shard[i] >= 0) {
+        ++positives;
+        int s = true_shard[i];
+        missed += ((bits[s >> 6] >> (s & 63)) & 1) == 0;
+      }
+    }
+    done += n;
+  }
+
+  // Each shard not holding the key is an independent standard Bloom
+  // filter of m_odd bits and keys_per_shard keys
+  double fp = std::pow(1.0 - std::exp(-(double)k * keys_per_shard /
+                                      sliced.m_odd), k);
+  double non_member_checks = (double)num_queries * shards - positives;
+  double q = (double)num_queries;
+  std::cout << argv[0] << " shards: " << shards
+    << " keys_per_shard: " << keys_per_shard
+    << " k: " << k
+    << " row_bits: " << sliced.row_bits
+    << " sliced_bytes: " << sliced.words() * 8
+    << " per_shard_bytes: " << per_shard.filter_words * shards * 8
+    << " sliced_add_ns: " << sliced_add_secs * 1e9 / (shards * keys_per_shard)
+    << " per_shard_add_ns: " << per_shard_add_secs * 1e9 / (shards * keys_per_shard)
+    << " sliced_ns_per_query: " << sliced_secs * 1e9 / q
+    << " per_shard_ns_per_query: " << per_shard_secs * 1e9 / q
+    << " speedup: " << per_shard_secs / sliced_secs
+    << " candidates_per_query: " << candidates / q
+    << " shard_fp_rate: " << (candidates - (positives - missed)) / non_member_checks
+    << " expected_shard_fp_rate: " << fp
+    << " false_negatives: " << missed
+    << " mismatches: " << mismatches << std::endl;
+  return missed == 0 && mismatches == 0 ? 0 : 1;
+}
@@ -22,26 +22,26 @@ for IMPL in $IMPLS; do
       KOPT="-DFIXED_K=$FIXED_K"
     fi
     if [ "$GPP" ]; then
-      CMD="$GPP -D$IMPL $KOPT -std=c++11 -march=native -mtune=native -O9 -o foo_gcc_${IMPL}_${FIXED_K}.out foo.cc"
+      CMD="$GPP -D$IMPL -DIMPL_NAME=\"$IMPL\" $KOPT -std=c++11 -pthread -march=native -mtune=native -O9 -o foo_gcc_${IMPL}_${FIXED_K}.out foo.cc"
       echo "$CMD"
       $CMD &
     else
       echo "NOTE: Skipping g++ build; compiler not found"
     fi
     if [ "$OLDGPP" ]; then
-      CMD="$OLDGPP -D$IMPL $KOPT -std=c++11 -march=native -mtune=native -O9 -o foo_oldgcc_${IMPL}_${FIXED_K}.out foo.cc"
+      CMD="$OLDGPP -D$IMPL -DIMPL_NAME=\"$IMPL\" $KOPT -std=c++11 -pthread -march=native -mtune=native -O9 -o foo_oldgcc_${IMPL}_${FIXED_K}.out foo.cc"
       echo "$CMD"
       $CMD &
     fi
     if [ "$CLANGPP" ]; then
-      CMD="$CLANGPP -D$IMPL $KOPT -std=c++11 -march=native -mtune=native -Ofast -o foo_clang_${IMPL}_${FIXED_K}.out foo.cc"
+      CMD="$CLANGPP -D$IMPL -DIMPL_NAME=\"$IMPL\" $KOPT -std=c++11 -pthread -march=native -mtune=native -Ofast -o foo_clang_${IMPL}_${FIXED_K}.out foo.cc"
       echo "$CMD"
       $CMD &
     else
       echo "NOTE: Skipping clang build; compiler not found"
     fi
     if [ "$ICC" ]; then
-      CMD="$ICC -D$IMPL $KOPT -std=c++11 -march=native -mtune=native -Ofast -o foo_intel_${IMPL}_${FIXED_K}.out foo.cc"
+      CMD="$ICC -D$IMPL -DIMPL_NAME=\"$IMPL\" $KOPT -std=c++11 -pthread -march=native -mtune=native -Ofast -o foo_intel_${IMPL}_${FIXED_K}.out foo.cc"
       echo "$CMD"
       $CMD &
     else
@@ -50,3 +50,21 @@ for IMPL in $IMPLS; do
   done
   wait
 done
+
+if [ "$GPP" ]; then
+  CMD="$GPP -std=c++11 -O2 -o optimize.out optimize.cc"
+  echo "$CMD"
+  $CMD
+fi
+
+if [ "$GPP" ]; then
+  CMD="$GPP -std=c++11 -O3 -march=native -o page_filter.out page_filter.cc"
+  echo "$CMD"
+  $CMD
+fi
+
+if [ "$GPP" ]; then
+  CMD="$GPP -std=c++11 -O3 -march=native -o bit_sliced.out bit_sliced.cc"
+  echo "$CMD"
+  $CMD
+fi
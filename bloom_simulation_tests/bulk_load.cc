@@ -0,0 +1,217 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Included from foo.cc (after the add/query implementation is selected).
+//
+// Builds the filter from a file of real keys, with two pipelined stages:
+// a reader thread doing large read()s, splitting keys and hashing them,
+// and the calling thread doing add(). The stages are connected by a bounded
+// single-producer single-consumer ring of hash batches, so end-to-end build
+// throughput is limited by the slower of (read + hash) and (add), not their
+// sum.
+//
+// Key file formats (option format=):
+//   lines  - newline-delimited keys (trailing '\r' is stripped)
+//   binary - fixed-size records of key_bytes= bytes each
+
+#include <atomic>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const size_t kLoadReadSize = 8 << 20;
+static const unsigned kLoadBatchSize = 4096;
+static const unsigned kLoadRingSlots = 64; // power of 2
+
+struct LoadBatch {
+  unsigned count;
+  uint64_t hashes[kLoadBatchSize];
+};
+
+struct LoadRing {
+  LoadBatch slots[kLoadRingSlots];
+  std::atomic<uint64_t> head{0}; // next slot to fill (producer)
+  std::atomic<uint64_t> tail{0}; // next slot to drain (consumer)
+  std::atomic<bool> done{false};
+  // Results from the producer, valid after done
+  uint64_t bytes = 0;
+  uint64_t keys = 0;
+  bool error = false;
+};
+
+// Producer side: wait for a free slot
+static LoadBatch *load_ring_acquire(LoadRing &ring) {
+  uint64_t head = ring.head.load(std::memory_order_relaxed);
+  while (head - ring.tail.load(std::memory_order_acquire) >= kLoadRingSlots) {
+    std::this_thread::yield();
+  }
+  LoadBatch *b = &ring.slots[head & (kLoadRingSlots - 1)];
+  b->count = 0;
+  return b;
+}
+
+static void load_ring_publish(LoadRing &ring) {
+  ring.head.store(ring.head.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_release);
+}
+
+static void load_hash_stage(LoadRing *ring, int fd, bool binary,
+                            size_t key_bytes) {
+  std::unique_ptr<char[]> buf(new char[kLoadReadSize]);
+  size_t carry = 0; // bytes of incomplete key at start of buf
+  LoadBatch *batch = load_ring_acquire(*ring);
+  for (;;) {
+    ssize_t got = read(fd, buf.get() + carry, kLoadReadSize - carry);
+    if (got < 0) {
+      ring->error = true;
+      break;
+    }
+    ring->bytes += got;
+    size_t avail = carry + got;
+    bool eof = got == 0;
+    const char *p = buf.get();
+    const char *end = p + avail;
+    for (;;) {
+      const char *key_end;
+      const char *next;
+      if (binary) {
+        if ((size_t)(end - p) < key_bytes) break;
+        key_end = next = p + key_bytes;
+      } else {
+        key_end = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (key_end == nullptr) {
+          // Final line without newline
+          if (!eof || p == end) break;
+          key_end = end;
+        }
+        next = key_end < end ? key_end + 1 : end;
+        if (key_end > p && key_end[-1] == '\r') --key_end;
+      }
+      batch->hashes[batch->count++] = XXH64(p, key_end - p, /*seed*/0);
+      ++ring->keys;
+      if (batch->count == kLoadBatchSize) {
+        load_ring_publish(*ring);
+        batch = load_ring_acquire(*ring);
+      }
+      p = next;
+    }
+    carry = end - p;
+    if (eof) {
+      // Leftover partial binary record is ignored
+      break;
+    }
+    if (carry >= kLoadReadSize) {
+      std::cerr << "Key longer than read buffer" << std::endl;
+      ring->error = true;
+      break;
+    }
+    memmove(buf.get(), p, carry);
+  }
+  if (batch->count > 0) {
+    load_ring_publish(*ring);
+  }
+  ring->done.store(true, std::memory_order_release);
+}
+
+// Returns process exit code
+static int bulk_load(const char *prog, const char *fname, const char *format,
+                     size_t key_bytes, std::mt19937_64 &r,
+                     int max_total_queries) {
+  bool binary;
+  if (strcmp(format, "lines") == 0) {
+    binary = false;
+  } else if (strcmp(format, "binary") == 0) {
+    binary = true;
+    if (key_bytes == 0) {
+      std::cerr << "format=binary requires key_bytes=" << std::endl;
+      return 2;
+    }
+  } else {
+    std::cerr << "Unknown format=" << format << std::endl;
+    return 2;
+  }
+  int fd = open(fname, O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Unable to open " << fname << std::endl;
+    return 2;
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  clear();
+  std::unique_ptr<LoadRing> ring(new LoadRing());
+
+  std::chrono::steady_clock::time_point time_begin = std::chrono::steady_clock::now();
+  std::thread producer(load_hash_stage, ring.get(), fd, binary, key_bytes);
+
+  // Insert stage
+  uint64_t tail = 0;
+  for (;;) {
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    if (tail == head) {
+      if (ring->done.load(std::memory_order_acquire) &&
+          tail == ring->head.load(std::memory_order_acquire)) {
+        break;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    for (; tail != head; ++tail) {
+      const LoadBatch &b = ring->slots[tail & (kLoadRingSlots - 1)];
+#ifdef ADD_BATCH
+      add_batch(b.hashes, b.count);
+#else
+      for (unsigned i = 0; i < b.count; ++i) {
+        add(b.hashes[i]);
+      }
+#endif
+      ring->tail.store(tail + 1, std::memory_order_release);
+    }
+  }
+  producer.join();
+  std::chrono::steady_clock::time_point time_end = std::chrono::steady_clock::now();
+  close(fd);
+  if (ring->error) {
+    std::cerr << "Error reading " << fname << std::endl;
+    return 1;
+  }
+
+  int total_fps = 0;
+  for (int total_queries = 0; total_queries < max_total_queries; ++total_queries) {
+    if (query(hash(r()))) {
+      total_fps++;
+    }
+  }
+
+  double secs = std::chrono::duration_cast<std::chrono::microseconds>(time_end - time_begin).count() / 1000000.0;
+  double n = (double)ring->keys;
+  std::cout << prog << " load_time: " << secs
+    << " keys: " << ring->keys
+    << " bytes: " << ring->bytes
+    << " GB/s: " << ring->bytes / secs / 1e9
+    << " Mkeys/s: " << n / secs / 1e6;
+  if (max_total_queries > 0) {
+    std::cout << " sampled_fp_rate: " << (double)total_fps / max_total_queries;
+  }
+  std::cout << " expected_fp_rate: " << bffp(m, n, k) << std::endl;
+  return 0;
+}
@@ -0,0 +1,189 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// FP rate models for standard and blocked (cache-local) Bloom filters.
+// Self-contained so that tools other than foo.cc can include it.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Standard Bloom filter FP rate without the exp() approximation of bffp
+static inline double bloom_fp_exact(double m, double n, unsigned k) {
+  if (n <= 0) {
+    return 0.0;
+  }
+  double p_set = -std::expm1(n * k * std::log1p(-1.0 / m));
+  return std::pow(p_set, k);
+}
+
+// Expected FP rate of a blocked Bloom filter where each key (and query)
+// picks one block uniformly and the query tests k bits within it. A
+// given bit of the block stays clear after one key is added with
+// probability q, so after j keys the query passes with probability
+// (1 - q^j)^k. The number of keys in the queried block is Poisson with
+// mean keys_per_block, and the result is the expectation over that.
+// The sum runs outward from the mode until terms vanish, so it costs
+// O(sqrt(keys_per_block)) terms.
+static inline double blocked_fp_rate_q(double keys_per_block, double q,
+                                       unsigned k) {
+  double lambda = keys_per_block;
+  if (lambda <= 0) {
+    return 0.0;
+  }
+  double log_q = std::log(q);
+  auto fp_given = [&](double j) {
+    return std::pow(-std::expm1(j * log_q), k);
+  };
+  double mode = std::floor(lambda);
+  double pmf_mode = std::exp(-lambda + mode * std::log(lambda) - std::lgamma(mode + 1));
+  double sum = pmf_mode * fp_given(mode);
+  double pmf = pmf_mode;
+  for (double j = mode + 1; ; j++) {
+    pmf *= lambda / j;
+    double term = pmf * fp_given(j);
+    sum += term;
+    if (pmf < 1e-16 || term <= sum * 1e-15) break;
+  }
+  pmf = pmf_mode;
+  for (double j = mode; j > 0; j--) {
+    pmf *= j / lambda;
+    sum += pmf * fp_given(j - 1);
+    if (pmf < 1e-16) break;
+  }
+  return sum;
+}
+
+// Standard Bloom filter within each block of block_bits: each key sets k
+// independently chosen bits (repeats allowed)
+static inline double blocked_fp_rate_per_block(double keys_per_block,
+                                               unsigned block_bits, unsigned k) {
+  return blocked_fp_rate_q(keys_per_block,
+                           std::pow(1.0 - 1.0 / block_bits, k), k);
+}
+
+// Same, for n keys in m bits total
+static inline double blocked_fp_rate(double m, double n, unsigned block_bits,
+                              unsigned k) {
+  return blocked_fp_rate_per_block(n * block_bits / m, block_bits, k);
+}
+
+// Exact version of blocked_fp_rate_per_block. The (1 - q^j)^k form above
+// treats the k queried bits as k independent bits, but repeats among the
+// query's k picks leave fewer distinct bits to test, and the bits of one
+// block are not independent given j keys. Both matter for small blocks
+// (FP about 10% higher than above for 64-bit blocks at 8 bits/key, k=8;
+// about 1% for 512-bit blocks). Here the number d of distinct query bits
+// has its exact distribution, and the chance that the j keys' k * j picks
+// cover all d bits is computed by dynamic programming over the picks.
+// Costs O(k^3 * keys_per_block), so it is for evaluating a configuration,
+// not for searches over k.
+static inline double blocked_fp_rate_per_block_exact(double keys_per_block,
+                                                     unsigned block_bits,
+                                                     unsigned k) {
+  double lambda = keys_per_block;
+  if (lambda <= 0 || k == 0) {
+    return 0.0;
+  }
+  double b = block_bits;
+  // Distribution of distinct bits among the query's k picks
+  std::vector<double> distinct(k + 1, 0.0), next(k + 1);
+  distinct[0] = 1.0;
+  for (unsigned t = 0; t < k; ++t) {
+    std::fill(next.begin(), next.end(), 0.0);
+    for (unsigned c = 0; c <= t; ++c) {
+      next[c] += distinct[c] * c / b;
+      next[c + 1] += distinct[c] * (b - c) / b;
+    }
+    distinct.swap(next);
+  }
+  unsigned max_j = (unsigned)(lambda + 12 * std::sqrt(lambda) + 20);
+  double log_lambda = std::log(lambda);
+  double sum = 0;
+  std::vector<double> covered;
+  for (unsigned d = 1; d <= k; ++d) {
+    if (distinct[d] == 0) {
+      continue;
+    }
+    // covered[c]: probability that c of the d bits are set so far
+    covered.assign(d + 1, 0.0);
+    covered[0] = 1.0;
+    double log_pmf = -lambda;
+    double pass = 0;
+    for (unsigned j = 1; j <= max_j; ++j) {
+      for (unsigned t = 0; t < k; ++t) {
+        for (unsigned c = d; c-- > 0;) {
+          double move = covered[c] * (d - c) / b;
+          covered[c] -= move;
+          covered[c + 1] += move;
+        }
+      }
+      log_pmf += log_lambda - std::log((double)j);
+      pass += std::exp(log_pmf) * covered[d];
+    }
+    sum += distinct[d] * pass;
+  }
+  return sum;
+}
+
+// k minimizing the blocked FP rate at bits_per_key, and that rate
+static inline unsigned best_blocked_k(double bits_per_key, unsigned block_bits,
+                               double *fp_out, unsigned max_k = 30) {
+  unsigned best_k = 1;
+  double best_fp = 2.0;
+  for (unsigned k = 1; k <= max_k; k++) {
+    double fp = blocked_fp_rate_per_block(block_bits / bits_per_key,
+                                          block_bits, k);
+    if (fp < best_fp) {
+      best_fp = fp;
+      best_k = k;
+    }
+  }
+  if (fp_out) {
+    *fp_out = best_fp;
+  }
+  return best_k;
+}
+
+// Best (lowest FP) block size among powers of two from 64 up to
+// max_block_bits, with its best k. Larger blocks are always more accurate,
+// so max_block_bits is the real choice (e.g. 512 for a 64-byte cache line);
+// this is mostly useful for the k and FP that come with it.
+static inline unsigned best_block_config(double bits_per_key, unsigned max_block_bits,
+                                  unsigned *k_out, double *fp_out) {
+  unsigned best_block = 64;
+  unsigned best_k = 1;
+  double best_fp = 2.0;
+  for (unsigned block_bits = 64; block_bits <= max_block_bits; block_bits *= 2) {
+    double fp;
+    unsigned k = best_blocked_k(bits_per_key, block_bits, &fp);
+    if (fp < best_fp) {
+      best_fp = fp;
+      best_k = k;
+      best_block = block_bits;
+    }
+  }
+  *k_out = best_k;
+  *fp_out = best_fp;
+  return best_block;
+}
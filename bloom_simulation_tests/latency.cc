@@ -0,0 +1,255 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Included from foo.cc. mode=latency: per-query (or per small batch, with
+// batch= up to 65536) latency distribution of query() on a populated structure, for
+// choosing schemes by tail latency rather than throughput. Query hashes
+// are generated outside the timed regions. Timing uses rdtscp (with
+// lfence so queries cannot start before the first timestamp), calibrated
+// against steady_clock, with the timer's own overhead subtracted.
+// Latencies go in a log-linear (HDR-style) histogram with 16 sub-buckets
+// per power of two, so reported percentiles are within about 6%.
+//
+// mode=dependent: each query key depends on the previous query() result,
+// as when a lookup decides the next key, so misses cannot overlap and the
+// result is per-lookup latency rather than throughput.
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t latency_ticks_begin() {
+  unsigned aux;
+  uint64_t t = __rdtscp(&aux);
+  _mm_lfence();
+  return t;
+}
+static inline uint64_t latency_ticks_end() {
+  unsigned aux;
+  return __rdtscp(&aux);
+}
+#else
+// No TSC; ticks are steady_clock nanoseconds
+static inline uint64_t latency_ticks_begin() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static inline uint64_t latency_ticks_end() {
+  return latency_ticks_begin();
+}
+#endif
+
+class LatencyHistogram {
+ public:
+  static const int kSubBits = 4;
+  static const int kSub = 1 << kSubBits;
+  static const int kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+  void add(uint64_t v) {
+    ++counts_[index(v)];
+    ++total_;
+    sum_ += v;
+    if (v > max_) max_ = v;
+  }
+
+  uint64_t total() const { return total_; }
+  uint64_t max() const { return max_; }
+  double mean() const { return total_ ? (double)sum_ / total_ : 0.0; }
+
+  // Midpoint of the bucket holding the given quantile
+  double percentile(double q) const {
+    uint64_t target = (uint64_t)std::ceil(q * total_);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+      seen += counts_[i];
+      if (seen >= target) {
+        return std::min((double)max_, (lower(i) + lower(i + 1)) / 2.0);
+      }
+    }
+    return (double)max_;
+  }
+
+ private:
+  static int index(uint64_t v) {
+    if (v < (uint64_t)kSub) {
+      return (int)v;
+    }
+    int e = 63 - __builtin_clzll(v);
+    int sub = (int)(v >> (e - kSubBits)) & (kSub - 1);
+    return ((e - kSubBits + 1) << kSubBits) + sub;
+  }
+
+  static double lower(int i) {
+    if (i < kSub) {
+      return i;
+    }
+    int e = (i >> kSubBits) + kSubBits - 1;
+    int sub = i & (kSub - 1);
+    return std::ldexp((double)(kSub + sub), e - kSubBits);
+  }
+
+  uint64_t counts_[kBuckets] = {};
+  uint64_t total_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
+
+// Ticks per nanosecond, measured over about 100ms
+static double latency_ticks_per_ns() {
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  uint64_t c0 = latency_ticks_end();
+  std::chrono::steady_clock::time_point t1;
+  do {
+    t1 = std::chrono::steady_clock::now();
+  } while (t1 - t0 < std::chrono::milliseconds(100));
+  uint64_t c1 = latency_ticks_end();
+  return (double)(c1 - c0) /
+      std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+// Minimum ticks for an empty timed region
+static uint64_t latency_overhead_ticks() {
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t t0 = latency_ticks_begin();
+    uint64_t t1 = latency_ticks_end();
+    best = std::min(best, t1 - t0);
+  }
+  return best;
+}
+
+// Returns process exit code
+static int latency_test(const char *prog, std::mt19937_64 &r,
+                        int max_total_queries, int batch) {
+  const int kMaxBatch = 65536;
+  if (batch < 1 || batch > kMaxBatch) {
+    std::cerr << "batch= must be 1 to " << kMaxBatch << std::endl;
+    return 2;
+  }
+  if (max_total_queries < batch) {
+    std::cerr << "Need at least batch= queries" << std::endl;
+    return 2;
+  }
+  clear();
+  for (unsigned i = 0; i < max_n; ++i) {
+    add(hash(r()));
+  }
+
+  double ticks_per_ns = latency_ticks_per_ns();
+  uint64_t overhead = latency_overhead_ticks();
+
+  const int kChunk = kMaxBatch / batch * batch;
+  std::unique_ptr<uint64_t[]> hashes(new uint64_t[kChunk]);
+  LatencyHistogram hist;
+  int total_fps = 0;
+  for (int done = 0; done < max_total_queries; ) {
+    int count = std::min(kChunk, (max_total_queries - done) / batch * batch);
+    if (count == 0) break;
+    for (int i = 0; i < count; ++i) {
+      hashes[i] = hash(r());
+    }
+    for (int i = 0; i < count; i += batch) {
+      uint64_t t0 = latency_ticks_begin();
+      for (int j = i; j < i + batch; ++j) {
+        total_fps += query(hashes[j]);
+      }
+      uint64_t t1 = latency_ticks_end();
+      uint64_t ticks = t1 - t0;
+      hist.add(ticks > overhead ? ticks - overhead : 0);
+    }
+    done += count;
+  }
+
+  // Per query
+  double scale = 1.0 / (ticks_per_ns * batch);
+  std::cout << prog << " latency_ns p50: " << hist.percentile(0.5) * scale
+    << " p90: " << hist.percentile(0.9) * scale
+    << " p99: " << hist.percentile(0.99) * scale
+    << " p999: " << hist.percentile(0.999) * scale
+    << " max: " << hist.max() * scale
+    << " mean: " << hist.mean() * scale
+    << " batch: " << batch
+    << " samples: " << hist.total()
+    << " ticks_per_ns: " << ticks_per_ns
+    << " overhead_ticks: " << overhead
+    << " sampled_fp_rate: " << (double)total_fps / (hist.total() * batch)
+    << std::endl;
+  return 0;
+}
+
+// Returns process exit code
+static int dependent_test(const char *prog, std::mt19937_64 &r,
+                          int max_total_queries, bool fence) {
+  clear();
+  for (unsigned i = 0; i < max_n; ++i) {
+    add(hash(r()));
+  }
+
+  const int kChunk = 65536;
+  std::unique_ptr<uint64_t[]> hashes(new uint64_t[kChunk]);
+  double dep_secs = 0;
+  double indep_secs = 0;
+  int dep_fps = 0;
+  int indep_fps = 0;
+  uint64_t dep = 0;
+  for (int done = 0; done < max_total_queries; ) {
+    int count = std::min(kChunk, max_total_queries - done);
+    for (int i = 0; i < count; ++i) {
+      hashes[i] = hash(r());
+    }
+    // Dependent: the result feeds the next key as data. Since a FP is rare
+    // the branches in query() predict well, and the CPU would speculate
+    // past that dependency; the lfence (unless fence=0) keeps the next
+    // query from starting until this one has completed.
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+      bool res = query(hashes[i] ^ dep);
+      dep = (uint64_t)res * 0x9e3779b97f4a7c15;
+      dep_fps += res;
+#if defined(__x86_64__) || defined(__i386__)
+      if (fence) {
+        _mm_lfence();
+      }
+#endif
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    // Independent, on the same keys, for comparison
+    for (int i = 0; i < count; ++i) {
+      indep_fps += query(hashes[i]);
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    dep_secs += std::chrono::duration<double>(t1 - t0).count();
+    indep_secs += std::chrono::duration<double>(t2 - t1).count();
+    done += count;
+  }
+
+  double dep_ns = dep_secs * 1e9 / max_total_queries;
+  double indep_ns = indep_secs * 1e9 / max_total_queries;
+  std::cout << prog << " dependent_ns_per_query: " << dep_ns
+    << " independent_ns_per_query: " << indep_ns
+    << " ratio: " << dep_ns / indep_ns
+    << " fence: " << fence
+    << " sampled_fp_rate: " << (double)dep_fps / max_total_queries
+    << " independent_sampled_fp_rate: " << (double)indep_fps / max_total_queries
+    << std::endl;
+  return 0;
+}
@@ -0,0 +1,149 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Included from foo.cc (after the add/query implementation is selected).
+//
+// Monte-Carlo FP rate estimation: many independent run_trial()s, each with
+// its own seed derived from (run number, seed), run concurrently. Since the
+// filter lives in globals, each run is a fork()ed child with its own copy,
+// reporting back through a pipe. The spread of FP rates across runs (which
+// includes the variance from the filter contents, not just from sampling
+// queries) gives a confidence interval for the mean, and the gate against
+// the model FP rate.
+
+#include <map>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct McResult {
+  int run;
+  int fps;
+  double seconds;
+};
+
+// Returns process exit code
+static int monte_carlo(const char *prog, int seed, int queries_per_run,
+                       int runs, int jobs) {
+  if (runs < 2 || queries_per_run <= 0) {
+    std::cerr << "mode=mc needs runs= at least 2 and queries > 0" << std::endl;
+    return 2;
+  }
+  if (jobs <= 0) {
+    jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs <= 0) jobs = 1;
+  }
+  std::cout << std::flush;
+
+  std::vector<McResult> results;
+  std::map<pid_t, int> active; // pid -> read fd
+  std::chrono::steady_clock::time_point time_begin = std::chrono::steady_clock::now();
+  int next_run = 0;
+  while (next_run < runs || !active.empty()) {
+    if (next_run < runs && (int)active.size() < jobs) {
+      int fds[2];
+      if (pipe(fds) != 0) {
+        std::cerr << "pipe failed" << std::endl;
+        return 1;
+      }
+      pid_t pid = fork();
+      if (pid < 0) {
+        std::cerr << "fork failed" << std::endl;
+        return 1;
+      }
+      if (pid == 0) {
+        close(fds[0]);
+        McResult res;
+        res.run = next_run;
+        std::mt19937_64 r(hash(next_run, seed));
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        res.fps = run_trial(r, queries_per_run);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        res.seconds = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000000.0;
+        bool ok = write(fds[1], &res, sizeof(res)) == (ssize_t)sizeof(res);
+        _exit(ok ? 0 : 1);
+      }
+      close(fds[1]);
+      active[pid] = fds[0];
+      ++next_run;
+      continue;
+    }
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0) {
+      std::cerr << "wait failed" << std::endl;
+      return 1;
+    }
+    std::map<pid_t, int>::iterator it = active.find(pid);
+    if (it == active.end()) {
+      continue;
+    }
+    McResult res;
+    bool ok = read(it->second, &res, sizeof(res)) == (ssize_t)sizeof(res);
+    close(it->second);
+    active.erase(it);
+    if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::cerr << "Run failed" << std::endl;
+      return 1;
+    }
+    results.push_back(res);
+  }
+  std::chrono::steady_clock::time_point time_end = std::chrono::steady_clock::now();
+
+  double sum = 0, sum_sq = 0, run_seconds = 0;
+  for (const McResult &res : results) {
+    double fp = (double)res.fps / queries_per_run;
+    sum += fp;
+    sum_sq += fp * fp;
+    run_seconds += res.seconds;
+  }
+  double mean = sum / runs;
+  double stddev = std::sqrt(std::max(0.0, (sum_sq - sum * mean) / (runs - 1)));
+  double stderr_mean = stddev / std::sqrt((double)runs);
+  // Normal approximation; fine for the typical dozens of runs
+  double half_width = 1.959964 * stderr_mean;
+
+  std::cout << prog << " runs: " << runs
+    << " jobs: " << jobs
+    << " queries_per_run: " << queries_per_run
+    << " wall_time: " << std::chrono::duration_cast<std::chrono::microseconds>(time_end - time_begin).count() / 1000000.0
+    << " mean_run_time: " << run_seconds / runs
+    << " mean_fp_rate: " << mean
+    << " stddev: " << stddev
+    << " ci95: [" << mean - half_width << ", " << mean + half_width << "]"
+    << " expected_fp_rate: " << bffp(m, max_n, k);
+#ifdef FP_RATE_CACHE
+  std::cout << " cache_line_rate(" << FP_RATE_CACHE << "): " << cache_fp_rate();
+#endif
+  // Test mean of runs against the model (plus tolerance, see
+  // fp_gate_rate()) using the observed spread, which
+  // accounts for filter-to-filter variance that a binomial test ignores
+  double gate_fp = fp_gate_rate();
+  double z = stderr_mean > 0 ? (mean - gate_fp) / stderr_mean
+                             : (mean > gate_fp ? 1e9 : -1e9);
+  double p_value = 0.5 * std::erfc(z / std::sqrt(2.0));
+  bool bad = fp_gated() && p_value < fp_alpha();
+  std::cout << " fp_p_value: " << p_value
+    << " verdict: " << (!fp_gated() ? "N/A" : bad ? "FAIL" : "PASS");
+  std::cout << std::endl;
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,275 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Chooses Bloom filter scheme, k and size for an expected number of keys
+// and a target FP rate and/or memory budget, using the FP models in
+// fp_model.cc and (optionally) ns/query measured with foo.cc. Prints the
+// Pareto-optimal configurations over (bits/key, FP rate, query cost).
+//
+// Usage: optimize.out N TARGET_FP MAX_BITS_PER_KEY [TIMING_FILE]
+//   TARGET_FP = 0 means no FP target: FP rate at MAX_BITS_PER_KEY
+//   MAX_BITS_PER_KEY = 0 means no memory budget (requires TARGET_FP)
+//   TIMING_FILE has lines "SCHEME K NS_PER_QUERY" (K = 0 for any k);
+//   without it, query cost is cache lines touched.
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "fp_model.cc"
+
+static unsigned round_up_to_pow2(unsigned v) {
+  unsigned rv = 1;
+  while (rv < v) {
+    rv <<= 1;
+  }
+  return rv;
+}
+
+// Schemes as implemented in foo.cc
+struct Scheme {
+  const char *name;
+  unsigned min_k;
+  unsigned max_k;
+  unsigned k_step;
+  // Block (cache-local) bits for k, or 0 for a standard Bloom filter
+  unsigned (*block_bits)(unsigned k);
+  // Probability that a given bit of the block is not set by one key
+  double (*q)(unsigned k);
+  bool hash32;
+};
+
+// Standard Bloom filter
+static unsigned std_block_bits(unsigned) { return 0; }
+static double std_q(unsigned) { return 0.0; }
+
+// Any k bits of a 512-bit line, repeats allowed
+static unsigned alt_block_bits(unsigned) { return 512; }
+static double alt_q(unsigned k) { return std::pow(1.0 - 1.0 / 512, k); }
+
+// Two unique bits in each of k/2 words (+1 bit for odd k) of a
+// round_up_to_pow2(k/2)-word block
+static unsigned block_block_bits(unsigned k) { return round_up_to_pow2(k / 2) * 64; }
+static double block_q(unsigned k) { return 1.0 - (double)k / block_block_bits(k); }
+
+// Two independent bits in each of k/2 words of a k/2-word block
+static unsigned pair_block_bits(unsigned k) { return (k / 2) * 64; }
+static double pair_q(unsigned) { return (1.0 - 1.0 / 64) * (1.0 - 1.0 / 64); }
+
+// One bit in each of k of the eight 32-bit lanes of 256 bits
+static unsigned simd_block_bits(unsigned) { return 256; }
+static double simd_q(unsigned k) { return 1.0 - k / 256.0; }
+
+static const Scheme schemes[] = {
+  { "WORM64", 1, 30, 1, std_block_bits, std_q, false },
+  { "CACHE_WORM64_ALT", 1, 30, 1, alt_block_bits, alt_q, false },
+  { "CACHE_WORM64_BLOCK", 2, 16, 1, block_block_bits, block_q, false },
+  { "CACHE_WORM64_BLOCKPAIR", 2, 16, 2, pair_block_bits, pair_q, false },
+  { "CACHE_SIMD_FASTRANGE32", 1, 8, 1, simd_block_bits, simd_q, true },
+};
+
+static double scheme_fp_rate(const Scheme &s, unsigned k, double n,
+                             double bits_per_key) {
+  double fp;
+  unsigned block_bits = s.block_bits(k);
+  if (block_bits == 0) {
+    fp = bloom_fp_exact(n * bits_per_key, n, k);
+  } else {
+    fp = blocked_fp_rate_q(block_bits / bits_per_key, s.q(k), k);
+  }
+  if (s.hash32) {
+    // Collisions on the 32-bit hash
+    fp += n * std::pow(2, -32);
+  }
+  return fp;
+}
+
+struct Timing {
+  std::string scheme;
+  unsigned k;
+  double ns;
+};
+
+// Measured ns/query, or < 0 if not available
+static double lookup_ns(const std::vector<Timing> &timings, const Scheme &s,
+                        unsigned k) {
+  double any = -1.0;
+  for (const Timing &t : timings) {
+    if (t.scheme == s.name) {
+      if (t.k == k) {
+        return t.ns;
+      } else if (t.k == 0) {
+        any = t.ns;
+      }
+    }
+  }
+  return any;
+}
+
+struct Config {
+  const Scheme *scheme;
+  unsigned k;
+  double bits_per_key;
+  double fp;
+  // FP rate for comparison: the target itself when sizing to a target
+  double fp_key;
+  double cost;
+};
+
+static bool dominates(const Config &a, const Config &b) {
+  return a.bits_per_key <= b.bits_per_key && a.fp_key <= b.fp_key
+      && a.cost <= b.cost
+      && (a.bits_per_key < b.bits_per_key || a.fp_key < b.fp_key
+          || a.cost < b.cost);
+}
+
+// Evaluate all schemes and k and return the Pareto-optimal configurations,
+// sorted by bits/key
+static std::vector<Config> optimize(double n, double target_fp,
+                                    double max_bits_per_key,
+                                    const std::vector<Timing> &timings) {
+  std::vector<Config> all;
+  for (const Scheme &s : schemes) {
+    for (unsigned k = s.min_k; k <= s.max_k; k += s.k_step) {
+      Config c;
+      c.scheme = &s;
+      c.k = k;
+      if (timings.empty()) {
+        c.cost = s.block_bits(k) == 0 ? k : 1;
+      } else {
+        c.cost = lookup_ns(timings, s, k);
+        if (c.cost < 0) {
+          continue;
+        }
+      }
+      if (target_fp > 0) {
+        // FP rate is decreasing in bits/key; bisect for the smallest
+        // meeting the target
+        double lo = 0.5, hi = 256.0;
+        if (scheme_fp_rate(s, k, n, hi) > target_fp) {
+          continue;
+        }
+        for (int i = 0; i < 60; ++i) {
+          double mid = (lo + hi) / 2;
+          if (scheme_fp_rate(s, k, n, mid) > target_fp) {
+            lo = mid;
+          } else {
+            hi = mid;
+          }
+        }
+        c.bits_per_key = hi;
+        if (max_bits_per_key > 0 && c.bits_per_key > max_bits_per_key) {
+          continue;
+        }
+      } else {
+        c.bits_per_key = max_bits_per_key;
+      }
+      c.fp = scheme_fp_rate(s, k, n, c.bits_per_key);
+      c.fp_key = target_fp > 0 ? target_fp : c.fp;
+      all.push_back(c);
+    }
+  }
+  std::vector<Config> pareto;
+  for (const Config &c : all) {
+    bool dominated = false;
+    for (const Config &d : all) {
+      if (dominates(d, c)) {
+        dominated = true;
+        break;
+      }
+    }
+    if (!dominated) {
+      pareto.push_back(c);
+    }
+  }
+  std::sort(pareto.begin(), pareto.end(), [](const Config &a, const Config &b) {
+    return a.bits_per_key < b.bits_per_key
+        || (a.bits_per_key == b.bits_per_key && a.fp < b.fp);
+  });
+  return pareto;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0]
+      << " N TARGET_FP MAX_BITS_PER_KEY [TIMING_FILE]" << std::endl;
+    return 2;
+  }
+  double n = std::atof(argv[1]);
+  double target_fp = std::atof(argv[2]);
+  double max_bits_per_key = std::atof(argv[3]);
+  if (n < 1 || (target_fp <= 0 && max_bits_per_key <= 0)) {
+    std::cerr << "Need N >= 1 and a TARGET_FP or MAX_BITS_PER_KEY" << std::endl;
+    return 2;
+  }
+
+  std::vector<Timing> timings;
+  if (argc > 4) {
+    std::ifstream in(argv[4]);
+    if (!in) {
+      std::cerr << "Unable to open " << argv[4] << std::endl;
+      return 2;
+    }
+    Timing t;
+    while (in >> t.scheme >> t.k >> t.ns) {
+      timings.push_back(t);
+    }
+  }
+  const char *cost_name = timings.empty() ? "lines_per_query" : "ns_per_query";
+
+  std::vector<Config> pareto = optimize(n, target_fp, max_bits_per_key, timings);
+  if (pareto.empty()) {
+    std::cerr << "No configuration meets the constraints" << std::endl;
+    return 1;
+  }
+  for (const Config &c : pareto) {
+    unsigned block_bits = c.scheme->block_bits(c.k);
+    // foo.cc rounds m to whole blocks
+    uint64_t m = (uint64_t)std::ceil(n * c.bits_per_key);
+    if (block_bits > 0) {
+      m = (m + block_bits - 1) / block_bits * block_bits;
+    }
+    std::cout << "scheme: " << c.scheme->name
+      << " k: " << c.k
+      << " block_bits: " << block_bits
+      << " bits_per_key: " << c.bits_per_key
+      << " m: " << m
+      << " fp_rate: " << c.fp
+      << " " << cost_name << ": " << c.cost << std::endl;
+  }
+  return 0;
+}
+
+/* Example
+$ ./optimize.out 1000000 0.01 0
+$ ./optimize.out 1000000 0 10
+$ echo "WORM64 0 35.2
+CACHE_WORM64_ALT 0 12.1
+CACHE_WORM64_BLOCK 0 6.3" > timing.txt
+$ ./optimize.out 1000000 0.01 12 timing.txt
+*/
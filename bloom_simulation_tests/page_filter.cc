@@ -0,0 +1,592 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Page-blocked Bloom filter stored in a file, for filters larger than RAM.
+// worm64(num_pages_odd, h) selects a 4 KiB page and further worm64 values
+// on the same h select k bits within it, so each query costs exactly one
+// page read. Queries are issued in batches through io_uring (raw
+// syscalls, no liburing), keeping up to depth= reads in flight, with a
+// one-at-a-time pread() fallback where io_uring is unavailable.
+//
+// Usage:
+//   page_filter.out build FILE NUM_KEYS BITS_PER_KEY K [seed=] [mem=1024]
+//   page_filter.out query FILE NUM_QUERIES [io=uring|pread] [depth=64]
+//                         [direct=0|1] [positive=0.0]
+//
+// Keys are hash(i, seed) for i < NUM_KEYS, so query can draw positives
+// (fraction positive=) without storing the keys. Any positive reported
+// absent is a bug and gives exit code 1. direct=1 opens with O_DIRECT to
+// measure the device rather than the page cache.
+//
+// build uses at most about mem= MiB of RAM. The filter is filled one
+// mem=-sized page range at a time and written sequentially; with more
+// than one range, all NUM_KEYS keys are regenerated for each range (so
+// build time grows with the number of ranges) and only those landing in
+// the range are added.
+//
+// File format (native endian): one 4 KiB header page (PageFileHeader),
+// then num_pages 4 KiB filter pages.
+
+#define XXH_INLINE_ALL
+#include "../third-party/xxHash/xxhash.h"
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "fp_model.cc"
+
+static const size_t kPageBytes = 4096;
+// Using an odd range keeps the worm64 chain full quality; the last bit of
+// each page is never used
+static const uint64_t kPageBitsOdd = kPageBytes * 8 - 1;
+static const char kPageFileMagic[8] = {'W', 'O', 'R', 'M', 'P', 'G', 'B', 'F'};
+static const uint32_t kPageFileVersion = 1;
+
+struct PageFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t k;
+  uint64_t num_pages;
+  uint64_t num_keys;
+  uint64_t seed;
+};
+
+static inline uint64_t hash(uint64_t v, uint64_t seed) {
+  return XXH64(&v, sizeof(v), seed);
+}
+
+static unsigned round_up_to_pow2(unsigned v) {
+  unsigned rv = 1;
+  while (rv < v) {
+    rv <<= 1;
+  }
+  return rv;
+}
+
+static inline uint64_t worm64(uint64_t a, uint64_t &h) {
+  __uint128_t wide = (__uint128_t)a * h;
+  h = (uint64_t)wide;
+  return (uint64_t)(wide >> 64);
+}
+
+// Like the _odd sizes in foo.cc: round down to odd (last page unused if
+// num_pages is even)
+static inline uint64_t pages_odd(uint64_t num_pages) {
+  return num_pages - (~num_pages & 1);
+}
+
+// h is advanced past the page selection, ready for page_add/page_query
+static inline uint64_t page_for(uint64_t num_pages_odd, uint64_t &h) {
+  return worm64(num_pages_odd, h);
+}
+
+static inline void page_add(uint8_t *page, unsigned k, uint64_t h) {
+  for (unsigned i = 0; i < k; ++i) {
+    uint64_t a = worm64(kPageBitsOdd, h);
+    page[a >> 3] |= (uint8_t)(1 << (a & 7));
+  }
+}
+
+static inline bool page_query(const uint8_t *page, unsigned k, uint64_t h) {
+  for (unsigned i = 0; i < k; ++i) {
+    uint64_t a = worm64(kPageBitsOdd, h);
+    if ((page[a >> 3] & (1 << (a & 7))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int opt_argc = 0;
+static char **opt_argv = nullptr;
+static int opt_first = 0;
+
+static const char *get_opt(const char *name, const char *default_value) {
+  size_t len = strlen(name);
+  for (int i = opt_first; i < opt_argc; ++i) {
+    if (strncmp(opt_argv[i], name, len) == 0 && opt_argv[i][len] == '=') {
+      return opt_argv[i] + len + 1;
+    }
+  }
+  return default_value;
+}
+
+static bool pwrite_all(int fd, const uint8_t *buf, size_t len, off_t off) {
+  while (len > 0) {
+    ssize_t n = pwrite(fd, buf, len, off);
+    if (n <= 0) {
+      return false;
+    }
+    buf += n;
+    len -= n;
+    off += n;
+  }
+  return true;
+}
+
+// Fills range_pages pages at a time in RAM and writes them sequentially,
+// rather than random writes through the page cache (see top comment)
+// Returns process exit code
+static int build(const char *prog, const char *fname, uint64_t num_keys,
+                 double bits_per_key, unsigned k, uint64_t seed,
+                 uint64_t range_pages) {
+  uint64_t num_pages = (uint64_t)std::ceil(num_keys * bits_per_key /
+                                           (kPageBytes * 8));
+  num_pages = std::max(num_pages, (uint64_t)1);
+  uint64_t num_pages_odd = pages_odd(num_pages);
+  size_t file_bytes = (num_pages + 1) * kPageBytes;
+  range_pages = std::min(std::max(range_pages, (uint64_t)1), num_pages);
+  uint64_t num_ranges = (num_pages + range_pages - 1) / range_pages;
+
+  int fd = open(fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::cerr << "Unable to create " << fname << std::endl;
+    return 2;
+  }
+  if (ftruncate(fd, file_bytes) != 0) {
+    std::cerr << "Unable to size " << fname << std::endl;
+    close(fd);
+    return 1;
+  }
+
+  std::unique_ptr<uint8_t[]> buf(new uint8_t[range_pages * kPageBytes]);
+  PageFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kPageFileMagic, sizeof(header.magic));
+  header.version = kPageFileVersion;
+  header.k = k;
+  header.num_pages = num_pages;
+  header.num_keys = num_keys;
+  header.seed = seed;
+  memset(buf.get(), 0, kPageBytes);
+  memcpy(buf.get(), &header, sizeof(header));
+  if (!pwrite_all(fd, buf.get(), kPageBytes, 0)) {
+    std::cerr << "Error writing " << fname << std::endl;
+    close(fd);
+    return 1;
+  }
+
+  std::chrono::steady_clock::time_point time_begin = std::chrono::steady_clock::now();
+  int rv = 0;
+  for (uint64_t lo = 0; lo < num_pages && rv == 0; lo += range_pages) {
+    uint64_t count = std::min(range_pages, num_pages - lo);
+    memset(buf.get(), 0, count * kPageBytes);
+    // Keys are synthetic, so regenerate all of them for each range and
+    // keep those landing in it
+    for (uint64_t i = 0; i < num_keys; ++i) {
+      uint64_t h = hash(i, seed);
+      uint64_t page = page_for(num_pages_odd, h) - lo;
+      if (page < count) {
+        page_add(buf.get() + page * kPageBytes, k, h);
+      }
+    }
+    if (!pwrite_all(fd, buf.get(), count * kPageBytes, (lo + 1) * kPageBytes)) {
+      std::cerr << "Error writing " << fname << std::endl;
+      rv = 1;
+    }
+  }
+  if (rv == 0 && fsync(fd) != 0) {
+    std::cerr << "Error writing " << fname << std::endl;
+    rv = 1;
+  }
+  std::chrono::steady_clock::time_point time_end = std::chrono::steady_clock::now();
+  close(fd);
+
+  double secs = std::chrono::duration<double>(time_end - time_begin).count();
+  std::cout << prog << " build_time: " << secs
+    << " keys: " << num_keys
+    << " pages: " << num_pages
+    << " bytes: " << file_bytes
+    << " ranges: " << num_ranges
+    << " Mkeys/s: " << num_keys / secs / 1e6 << std::endl;
+  return rv;
+}
+
+// Minimal io_uring over raw syscalls: one SQ/CQ pair, IORING_OP_READ only
+struct Uring {
+  int fd = -1;
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  io_uring_sqe *sqes = nullptr;
+  io_uring_cqe *cqes = nullptr;
+  void *sq_ptr = MAP_FAILED;
+  void *cq_ptr = MAP_FAILED;
+  size_t sq_bytes = 0, cq_bytes = 0, sqes_bytes = 0;
+  unsigned to_submit = 0;
+
+  // Returns 0 or an errno value
+  int init(unsigned entries) {
+    io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (fd < 0) {
+      fd = -1;
+      return errno;
+    }
+    sq_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_bytes = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+      sq_bytes = cq_bytes = std::max(sq_bytes, cq_bytes);
+    }
+    sq_ptr = mmap(nullptr, sq_bytes, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED) {
+      return errno;
+    }
+    if (single) {
+      cq_ptr = sq_ptr;
+    } else {
+      cq_ptr = mmap(nullptr, cq_bytes, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cq_ptr == MAP_FAILED) {
+        return errno;
+      }
+    }
+    size_t bytes = p.sq_entries * sizeof(io_uring_sqe);
+    void *s = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (s == MAP_FAILED) {
+      return errno;
+    }
+    sqes = static_cast<io_uring_sqe *>(s);
+    sqes_bytes = bytes;
+    char *sq = static_cast<char *>(sq_ptr);
+    char *cq = static_cast<char *>(cq_ptr);
+    sq_head = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+    cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+    return 0;
+  }
+
+  ~Uring() {
+    if (sqes != nullptr) munmap(sqes, sqes_bytes);
+    if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_bytes);
+    if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_bytes);
+    if (fd >= 0) close(fd);
+  }
+
+  // Caller keeps in-flight reads within the ring size
+  void prep_read(int file_fd, void *buf, unsigned bytes, uint64_t offset,
+                 uint64_t user_data) {
+    unsigned tail = *sq_tail;
+    unsigned idx = tail & *sq_mask;
+    io_uring_sqe *sqe = &sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = file_fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = bytes;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    sq_array[idx] = idx;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++to_submit;
+  }
+
+  // Submit pending reads and wait for at least min_complete completions.
+  // Returns 0 or an errno value.
+  int submit_and_wait(unsigned min_complete) {
+    for (;;) {
+      long r = syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                       IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (r >= 0) {
+        to_submit -= (unsigned)r;
+        return 0;
+      }
+      if (errno != EINTR) {
+        return errno;
+      }
+    }
+  }
+
+  // Calls fn(user_data, res) for each available completion
+  template <typename Fn>
+  void reap(Fn fn) {
+    unsigned head = *cq_head;
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const io_uring_cqe &cqe = cqes[head & *cq_mask];
+      fn(cqe.user_data, cqe.res);
+    }
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+  }
+};
+
+// State of an open filter file for querying
+struct PageFile {
+  int fd = -1;
+  PageFileHeader header;
+  uint64_t num_pages_odd = 0;
+
+  ~PageFile() {
+    if (fd >= 0) close(fd);
+  }
+};
+
+// Returns process exit code
+static int open_page_file(const char *fname, bool direct, PageFile &pf) {
+  pf.fd = open(fname, O_RDONLY | (direct ? O_DIRECT : 0));
+  if (pf.fd < 0 && direct && errno == EINVAL) {
+    std::cerr << "NOTE: O_DIRECT not supported for " << fname
+              << "; using page cache" << std::endl;
+    pf.fd = open(fname, O_RDONLY);
+  }
+  if (pf.fd < 0) {
+    std::cerr << "Unable to open " << fname << std::endl;
+    return 2;
+  }
+  // Header page read like the others, so O_DIRECT alignment holds
+  void *buf;
+  if (posix_memalign(&buf, kPageBytes, kPageBytes) != 0) {
+    return 1;
+  }
+  ssize_t got = pread(pf.fd, buf, kPageBytes, 0);
+  memcpy(&pf.header, buf, sizeof(pf.header));
+  free(buf);
+  if (got != (ssize_t)kPageBytes ||
+      memcmp(pf.header.magic, kPageFileMagic, sizeof(kPageFileMagic)) != 0 ||
+      pf.header.version != kPageFileVersion || pf.header.num_pages == 0) {
+    std::cerr << "Not a page filter file: " << fname << std::endl;
+    return 2;
+  }
+  pf.num_pages_odd = pages_odd(pf.header.num_pages);
+  return 0;
+}
+
+// Query results for hs[0..n) into found[], one page read each with
+// pread(). Returns 0 or an errno value.
+static int query_batch_pread(const PageFile &pf, uint8_t *buf,
+                             const uint64_t *hs, size_t n, bool *found) {
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t h = hs[i];
+    uint64_t page = page_for(pf.num_pages_odd, h);
+    ssize_t got = pread(pf.fd, buf, kPageBytes, (page + 1) * kPageBytes);
+    if (got != (ssize_t)kPageBytes) {
+      return got < 0 ? errno : EIO;
+    }
+    found[i] = page_query(buf, pf.header.k, h);
+  }
+  return 0;
+}
+
+// Same as query_batch_pread, but with up to depth reads in flight on
+// ring (which must have at least depth entries), using depth pages of
+// bufs. Returns 0 or an errno value.
+static int query_batch_uring(const PageFile &pf, Uring &ring, uint8_t *bufs,
+                             unsigned depth, const uint64_t *hs, size_t n,
+                             bool *found) {
+  // Query index for each in-flight buffer slot
+  std::vector<size_t> slot_query(depth);
+  std::vector<uint64_t> slot_h(depth);
+  size_t next = 0;
+  size_t done = 0;
+  int err = 0;
+  auto issue = [&](unsigned slot) {
+    uint64_t h = hs[next];
+    uint64_t page = page_for(pf.num_pages_odd, h);
+    slot_query[slot] = next++;
+    slot_h[slot] = h;
+    ring.prep_read(pf.fd, bufs + slot * kPageBytes, kPageBytes,
+                   (page + 1) * kPageBytes, slot);
+  };
+  for (unsigned slot = 0; slot < depth && next < n; ++slot) {
+    issue(slot);
+  }
+  while (done < n) {
+    int e = ring.submit_and_wait(1);
+    if (e != 0) {
+      return e;
+    }
+    ring.reap([&](uint64_t slot, int res) {
+      if (res != (int)kPageBytes) {
+        err = res < 0 ? -res : EIO;
+      } else {
+        found[slot_query[slot]] =
+            page_query(bufs + slot * kPageBytes, pf.header.k, slot_h[slot]);
+      }
+      ++done;
+      if (next < n) {
+        issue((unsigned)slot);
+      }
+    });
+    if (err != 0) {
+      return err;
+    }
+  }
+  return 0;
+}
+
+// Returns process exit code
+static int query(const char *prog, const char *fname, uint64_t num_queries) {
+  const char *io = get_opt("io", "uring");
+  unsigned depth = (unsigned)std::atoi(get_opt("depth", "64"));
+  bool direct = std::atoi(get_opt("direct", "0")) != 0;
+  double positive = std::atof(get_opt("positive", "0"));
+  if (depth < 1 || depth > 4096) {
+    std::cerr << "depth= must be in 1..4096" << std::endl;
+    return 2;
+  }
+
+  PageFile pf;
+  int rv = open_page_file(fname, direct, pf);
+  if (rv != 0) {
+    return rv;
+  }
+  const PageFileHeader &hdr = pf.header;
+
+  bool use_uring = strcmp(io, "uring") == 0;
+  if (!use_uring && strcmp(io, "pread") != 0) {
+    std::cerr << "Unknown io=" << io << std::endl;
+    return 2;
+  }
+  Uring ring;
+  if (use_uring) {
+    int e = ring.init(round_up_to_pow2(depth));
+    if (e != 0) {
+      std::cerr << "NOTE: io_uring unavailable (" << strerror(e)
+                << "); using pread" << std::endl;
+      use_uring = false;
+    }
+  }
+  if (!use_uring) {
+    depth = 1;
+  }
+
+  void *mem;
+  if (posix_memalign(&mem, kPageBytes, depth * kPageBytes) != 0) {
+    return 1;
+  }
+  std::unique_ptr<uint8_t, decltype(&free)> bufs(static_cast<uint8_t *>(mem),
+                                                 &free);
+
+  // Queries in batches, generated outside the timed region
+  const size_t kBatch = 65536;
+  std::vector<uint64_t> hs(kBatch);
+  std::vector<uint8_t> is_positive(kBatch);
+  std::unique_ptr<bool[]> found(new bool[kBatch]);
+  std::mt19937_64 rng(hdr.seed ^ 0x9e3779b97f4a7c15);
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+  uint64_t positives = 0, positives_found = 0, negatives = 0, fps = 0;
+  double secs = 0;
+  for (uint64_t remaining = num_queries; remaining > 0;) {
+    size_t n = (size_t)std::min<uint64_t>(remaining, kBatch);
+    remaining -= n;
+    for (size_t i = 0; i < n; ++i) {
+      is_positive[i] = hdr.num_keys > 0 && coin(rng) < positive;
+      // Keys at or above num_keys were never added
+      uint64_t key = is_positive[i] ? rng() % hdr.num_keys
+                                    : hdr.num_keys + (rng() >> 1);
+      hs[i] = hash(key, hdr.seed);
+    }
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    int e = use_uring
+        ? query_batch_uring(pf, ring, bufs.get(), depth, hs.data(), n,
+                            found.get())
+        : query_batch_pread(pf, bufs.get(), hs.data(), n, found.get());
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    secs += std::chrono::duration<double>(t1 - t0).count();
+    if (e != 0) {
+      std::cerr << "Error reading " << fname << ": " << strerror(e) << std::endl;
+      return 1;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      if (is_positive[i]) {
+        ++positives;
+        positives_found += found[i];
+      } else {
+        ++negatives;
+        fps += found[i];
+      }
+    }
+  }
+
+  double keys_per_page = (double)hdr.num_keys / pf.num_pages_odd;
+  std::cout << prog << " query_time: " << secs
+    << " queries: " << num_queries
+    << " io: " << (use_uring ? "uring" : "pread")
+    << " depth: " << depth
+    << " kQPS: " << num_queries / secs / 1e3
+    << " us/query: " << secs * 1e6 / num_queries;
+  if (negatives > 0) {
+    std::cout << " sampled_fp_rate: " << (double)fps / negatives;
+  }
+  std::cout << " expected_fp_rate: "
+    << blocked_fp_rate_per_block(keys_per_page, kPageBitsOdd, hdr.k);
+  if (positives > 0) {
+    std::cout << " positives_found: " << positives_found << "/" << positives;
+  }
+  std::cout << std::endl;
+  if (positives_found != positives) {
+    std::cout << prog << " FALSE NEGATIVES" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  opt_argc = argc;
+  opt_argv = argv;
+  if (argc >= 6 && strcmp(argv[1], "build") == 0) {
+    opt_first = 6;
+    uint64_t seed = std::strtoull(get_opt("seed", "1"), nullptr, 10);
+    uint64_t mem_mib = std::strtoull(get_opt("mem", "1024"), nullptr, 10);
+    unsigned k = (unsigned)std::atoi(argv[5]);
+    if (k < 1) {
+      std::cerr << "Need K >= 1" << std::endl;
+      return 2;
+    }
+    return build(argv[0], argv[2], std::strtoull(argv[3], nullptr, 10),
+                 std::atof(argv[4]), k, seed,
+                 (mem_mib << 20) / kPageBytes);
+  }
+  if (argc >= 4 && strcmp(argv[1], "query") == 0) {
+    opt_first = 4;
+    return query(argv[0], argv[2], std::strtoull(argv[3], nullptr, 10));
+  }
+  std::cerr << "Usage: " << argv[0]
+    << " build FILE NUM_KEYS BITS_PER_KEY K [seed=] [mem=1024]"
+    << std::endl
+    << "       " << argv[0]
+    << " query FILE NUM_QUERIES [io=uring|pread] [depth=64] [direct=0|1]"
+       " [positive=0.0]" << std::endl;
+  return 2;
+}
@@ -0,0 +1,160 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Optional hardware performance counters (Linux perf_event_open) for
+// benchmark phases. Each PerfCounters counts only while enabled, so one
+// instance per phase accumulates that phase across repeated
+// enable()/disable(). Events that cannot be opened (no PMU in a VM,
+// perf_event_paranoid, unsupported cache event) are reported as
+// unavailable rather than failing the run.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum PerfEvent {
+  kPerfCycles,
+  kPerfInstructions,
+  kPerfL1dMisses,
+  kPerfLlcMisses,
+  kPerfDtlbMisses,
+  kPerfBranchMisses,
+  kNumPerfEvents
+};
+
+static const char *const kPerfEventNames[kNumPerfEvents] = {
+  "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses",
+  "branch_misses",
+};
+
+static uint64_t perf_cache_config(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+               | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+class PerfCounters {
+ public:
+  PerfCounters() {
+    for (int i = 0; i < kNumPerfEvents; ++i) {
+      fds_[i] = -1;
+    }
+  }
+  ~PerfCounters() {
+    for (int i = 0; i < kNumPerfEvents; ++i) {
+      if (fds_[i] >= 0) {
+        close(fds_[i]);
+      }
+    }
+  }
+
+  // Open all events for the calling thread, disabled. Returns number of
+  // events opened; the first failure reason is kept in error().
+  int open() {
+    int opened = 0;
+    for (int i = 0; i < kNumPerfEvents; ++i) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+      switch (i) {
+        case kPerfCycles:
+          attr.type = PERF_TYPE_HARDWARE;
+          attr.config = PERF_COUNT_HW_CPU_CYCLES;
+          break;
+        case kPerfInstructions:
+          attr.type = PERF_TYPE_HARDWARE;
+          attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+          break;
+        case kPerfL1dMisses:
+          attr.type = PERF_TYPE_HW_CACHE;
+          attr.config = perf_cache_config(PERF_COUNT_HW_CACHE_L1D);
+          break;
+        case kPerfLlcMisses:
+          attr.type = PERF_TYPE_HW_CACHE;
+          attr.config = perf_cache_config(PERF_COUNT_HW_CACHE_LL);
+          break;
+        case kPerfDtlbMisses:
+          attr.type = PERF_TYPE_HW_CACHE;
+          attr.config = perf_cache_config(PERF_COUNT_HW_CACHE_DTLB);
+          break;
+        case kPerfBranchMisses:
+          attr.type = PERF_TYPE_HARDWARE;
+          attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+          break;
+      }
+      fds_[i] = (int)syscall(__NR_perf_event_open, &attr, /*pid*/0,
+                             /*cpu*/-1, /*group_fd*/-1, /*flags*/0);
+      if (fds_[i] >= 0) {
+        ++opened;
+      } else if (error_.empty()) {
+        error_ = std::string(kPerfEventNames[i]) + ": " + strerror(errno);
+      }
+    }
+    return opened;
+  }
+
+  void enable() {
+    for (int i = 0; i < kNumPerfEvents; ++i) {
+      if (fds_[i] >= 0) {
+        ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  void disable() {
+    for (int i = 0; i < kNumPerfEvents; ++i) {
+      if (fds_[i] >= 0) {
+        ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+  }
+
+  bool available(int i) const { return fds_[i] >= 0; }
+
+  // Count so far, scaled up if the kernel multiplexed the counter
+  double value(int i) const {
+    uint64_t buf[3];
+    if (fds_[i] < 0 || read(fds_[i], buf, sizeof(buf)) != sizeof(buf)) {
+      return 0.0;
+    }
+    if (buf[2] == 0) {
+      return 0.0;
+    }
+    return (double)buf[0] * ((double)buf[1] / buf[2]);
+  }
+
+  const std::string &error() const { return error_; }
+
+ private:
+  int fds_[kNumPerfEvents];
+  std::string error_;
+};
@@ -0,0 +1,167 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Included from foo.cc. Structured (format=json or format=csv) output of
+// the standard benchmark, one record per run, for summarize.sh and other
+// tools. CSV columns are in the order of kReportFields; header=1 prints
+// the header line first.
+
+#include <fstream>
+#include <string>
+
+#ifndef IMPL_NAME
+// Normally from build.sh (-DIMPL_NAME="IMPL_...")
+#define IMPL_NAME ""
+#endif
+
+struct RunRecord {
+  const char *prog;
+  int64_t seed;
+  double secs;
+  PhaseTimes times;
+  uint64_t queries;
+  double s_fp;
+  double e_fp;
+  double model_fp;
+  double p_value;
+  bool bad;
+  bool gated;
+};
+
+static const char *const kReportFields[] = {
+  "impl", "compiler", "cpu", "k", "m", "n", "seed", "queries", "time",
+  "ns_per_add", "ns_per_query", "sampled_fp_rate", "expected_fp_rate",
+  "model_fp_rate", "fp_p_value", "verdict", "prog",
+  // Per-op counters with perf=1 (null/empty if unavailable)
+  "add_cycles_per_op", "add_instructions_per_op", "add_l1d_misses_per_op",
+  "add_llc_misses_per_op", "add_dtlb_misses_per_op",
+  "add_branch_misses_per_op",
+  "query_cycles_per_op", "query_instructions_per_op",
+  "query_l1d_misses_per_op", "query_llc_misses_per_op",
+  "query_dtlb_misses_per_op", "query_branch_misses_per_op",
+};
+
+static std::string compiler_name() {
+#if defined(__INTEL_COMPILER)
+  return "intel " + std::to_string(__INTEL_COMPILER);
+#elif defined(__clang__)
+  return "clang " __clang_version__;
+#elif defined(__GNUC__)
+  return "gcc " __VERSION__;
+#else
+  return "unknown";
+#endif
+}
+
+static std::string cpu_model() {
+  std::ifstream in("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      size_t colon = line.find(':');
+      if (colon != std::string::npos) {
+        return line.substr(line.find_first_not_of(" \t", colon + 1));
+      }
+    }
+  }
+  return "unknown";
+}
+
+// Quote for JSON or CSV (doubling quotes for CSV)
+static std::string quoted(const std::string &s, bool json) {
+  std::string rv = "\"";
+  for (char c : s) {
+    if (c == '"') {
+      rv += json ? "\\\"" : "\"\"";
+    } else if (c == '\\' && json) {
+      rv += "\\\\";
+    } else {
+      rv += c;
+    }
+  }
+  return rv + "\"";
+}
+
+static void print_record(const char *format, const RunRecord &rec) {
+  bool json = strcmp(format, "json") == 0;
+  std::string impl = IMPL_NAME;
+  if (impl.empty()) {
+    impl = rec.prog;
+  }
+  std::string values[] = {
+    quoted(impl, json),
+    quoted(compiler_name(), json),
+    quoted(cpu_model(), json),
+    std::to_string(k),
+    std::to_string(m),
+    std::to_string(max_n),
+    std::to_string(rec.seed),
+    std::to_string(rec.queries),
+    std::to_string(rec.secs),
+    std::to_string(rec.times.adds ? rec.times.add_secs * 1e9 / rec.times.adds : 0.0),
+    std::to_string(rec.queries ? rec.times.query_secs * 1e9 / rec.queries : 0.0),
+    "", "", "", "", // FP values below, for full precision
+    quoted(!rec.gated ? "N/A" : rec.bad ? "FAIL" : "PASS", json),
+    quoted(rec.prog, json),
+    "", "", "", "", "", "", "", "", "", "", "", "", // perf counters
+  };
+  double fps[] = { rec.s_fp, rec.e_fp, rec.model_fp, rec.p_value };
+  for (int i = 0; i < 4; ++i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6g", fps[i]);
+    values[11 + i] = buf;
+  }
+  const size_t perf_base = 17;
+  for (int i = 0; i < 2 * kNumPerfEvents; ++i) {
+    const PerfCounters *ctr = i < kNumPerfEvents ? rec.times.add_perf
+                                                 : rec.times.query_perf;
+    int e = i % kNumPerfEvents;
+    double ops = i < kNumPerfEvents ? rec.times.adds : rec.queries;
+    if (ctr && ctr->available(e) && ops > 0) {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%.6g", ctr->value(e) / ops);
+      values[perf_base + i] = buf;
+    } else if (json) {
+      values[perf_base + i] = "null";
+    }
+  }
+  const size_t nfields = sizeof(kReportFields) / sizeof(kReportFields[0]);
+  if (!json && strcmp(get_opt("header", "0"), "1") == 0) {
+    for (size_t i = 0; i < nfields; ++i) {
+      std::cout << (i ? "," : "") << kReportFields[i];
+    }
+    std::cout << std::endl;
+  }
+  if (json) {
+    std::cout << "{";
+    for (size_t i = 0; i < nfields; ++i) {
+      std::cout << (i ? ", " : "") << "\"" << kReportFields[i] << "\": " << values[i];
+    }
+    std::cout << "}" << std::endl;
+  } else {
+    for (size_t i = 0; i < nfields; ++i) {
+      std::cout << (i ? "," : "") << values[i];
+    }
+    std::cout << std::endl;
+  }
+}
@@ -0,0 +1,73 @@
+#! /bin/bash
+
+# Summarize structured results from foo.cc (format=json or format=csv,
+# any mix, e.g. appended from many runs) by configuration: number of runs,
+# medians of ns/add, ns/query and sampled FP rate, and rank by median of
+# FIELD (default ns_per_query; lower is better).
+#
+# Usage: summarize.sh FILE [FIELD]
+
+FILE="$1"
+FIELD="${2:-ns_per_query}"
+
+[ -e "$FILE" ] || exit 1
+
+# Default CSV column order, as kReportFields in report.cc
+COLS="impl,compiler,cpu,k,m,n,seed,queries,time,ns_per_add,ns_per_query,sampled_fp_rate,expected_fp_rate,model_fp_rate,fp_p_value,verdict,prog,add_cycles_per_op,add_instructions_per_op,add_l1d_misses_per_op,add_llc_misses_per_op,add_dtlb_misses_per_op,add_branch_misses_per_op,query_cycles_per_op,query_instructions_per_op,query_l1d_misses_per_op,query_llc_misses_per_op,query_dtlb_misses_per_op,query_branch_misses_per_op"
+
+awk -v cols="$COLS" -v field="$FIELD" '
+function unquote(v) {
+  sub(/^[ \t]*/, "", v); sub(/[ \t]*$/, "", v);
+  if (v ~ /^".*"$/) { v = substr(v, 2, length(v) - 2); gsub(/""/, "\"", v); gsub(/\\"/, "\"", v) }
+  return v
+}
+# Split a CSV line, honoring double quotes
+function split_csv(line, out,   n, i, c, cur, inq) {
+  n = 0; cur = ""; inq = 0
+  for (i = 1; i <= length(line); i++) {
+    c = substr(line, i, 1)
+    if (c == "\"") { inq = !inq; cur = cur c }
+    else if (c == "," && !inq) { out[++n] = cur; cur = "" }
+    else { cur = cur c }
+  }
+  out[++n] = cur
+  return n
+}
+BEGIN { ncols = split(cols, colname, ",") }
+/^[ \t]*$/ { next }
+/^impl,/ { ncols = split($0, colname, ","); next }
+{
+  delete rec
+  if ($0 ~ /^[ \t]*\{/) {
+    rest = $0
+    while (match(rest, /"[a-z_0-9]+": *("[^"]*"|[^,}]*)/)) {
+      kv = substr(rest, RSTART, RLENGTH)
+      rest = substr(rest, RSTART + RLENGTH)
+      colon = index(kv, ":")
+      rec[unquote(substr(kv, 1, colon - 1))] = unquote(substr(kv, colon + 1))
+    }
+  } else {
+    n = split_csv($0, vals)
+    for (i = 1; i <= n && i <= ncols; i++) rec[colname[i]] = unquote(vals[i])
+  }
+  key = rec["impl"] "\t" rec["compiler"] "\t" rec["cpu"] "\t" rec["k"] "\t" rec["m"]
+  print key "\t" rec[field] "\t" rec["ns_per_add"] "\t" rec["ns_per_query"] "\t" rec["sampled_fp_rate"]
+}' "$FILE" | sort -t$'\t' -k1,5 -k6,6g | awk -F'\t' -v field="$FIELD" '
+function median(arr, n,   i, j, t) {
+  # insertion sort (small n)
+  for (i = 2; i <= n; i++) { t = arr[i]; for (j = i - 1; j >= 1 && arr[j] > t; j--) arr[j + 1] = arr[j]; arr[j + 1] = t }
+  return n % 2 ? arr[(n + 1) / 2] : (arr[n / 2] + arr[n / 2 + 1]) / 2
+}
+function flush() {
+  if (cnt == 0) return
+  printf "%s\t%d\t%g\t%g\t%g\t%g\n", prev, cnt, median(f, cnt), median(a, cnt), median(q, cnt), median(p, cnt)
+  cnt = 0; delete f; delete a; delete q; delete p
+}
+{
+  key = $1 "\t" $2 "\t" $3 "\t" $4 "\t" $5
+  if (key != prev) { flush(); prev = key }
+  cnt++; f[cnt] = $6 + 0; a[cnt] = $7 + 0; q[cnt] = $8 + 0; p[cnt] = $9 + 0
+}
+END { flush() }' | sort -t$'\t' -k7,7g | awk -F'\t' -v field="$FIELD" '
+BEGIN { OFS = "\t"; print "rank", "impl", "compiler", "cpu", "k", "m", "runs", "median_" field, "median_ns_per_add", "median_ns_per_query", "median_sampled_fp_rate" }
+{ print NR, $1, $2, $3, $4, $5, $6, $7, $8, $9, $10 }'
@@ -0,0 +1,118 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Included from foo.cc. mode=window: stream the given number of inserts
+// (the queries argument) through an IMPL with rotate() (ROTATE), rotating
+// every max_n / gens inserts so the window holds about max_n keys, and
+// report insert throughput including rotation. Then, with hashes
+// generated outside the timed region, query keys still in the window
+// (any miss is a bug), keys that have expired, and keys never added; the
+// last two should both match the model FP rate for the window's keys.
+
+// Returns process exit code
+static int window_test(const char *prog, std::mt19937_64 &r,
+                       int max_total_queries) {
+#ifdef ROTATE
+  uint64_t per_gen = std::max(1u, max_n / window_gens);
+  uint64_t total = (uint64_t)std::max(0, max_total_queries);
+  // Keys are hash(i, salt), so earlier ones can be regenerated
+  uint64_t salt = r();
+  const int kChunk = 65536;
+  std::unique_ptr<uint64_t[]> hashes(new uint64_t[kChunk]);
+
+  clear();
+  uint64_t rotations = 0;
+  double insert_secs = 0;
+  for (uint64_t done = 0; done < total; ) {
+    int count = (int)std::min<uint64_t>(kChunk, total - done);
+    for (int i = 0; i < count; ++i) {
+      hashes[i] = hash(done + i, salt);
+    }
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+      if ((done + i) % per_gen == 0 && done + i > 0) {
+        rotate();
+        ++rotations;
+      }
+      add(hashes[i]);
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    insert_secs += std::chrono::duration<double>(t1 - t0).count();
+    done += count;
+  }
+
+  // Keys from the current epoch's first key back through gens - 1 more
+  // epochs are live; everything before that has expired
+  uint64_t cur_first = total == 0 ? 0 : (total - 1) / per_gen * per_gen;
+  uint64_t live_first = cur_first >= (window_gens - 1) * per_gen
+                        ? cur_first - (window_gens - 1) * per_gen : 0;
+  uint64_t live = total - live_first;
+  uint64_t samples = std::min<uint64_t>(1000000, std::max<uint64_t>(total, 1));
+  uint64_t misses = 0, expired_fps = 0, fresh_fps = 0, expired_n = 0;
+  std::vector<uint64_t> live_hashes(live > 0 ? samples : 0);
+  for (uint64_t &h : live_hashes) {
+    h = hash(live_first + r() % live, salt);
+  }
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (uint64_t h : live_hashes) {
+    misses += !query(h);
+  }
+  std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < samples && live_first > 0; ++i, ++expired_n) {
+    expired_fps += query(hash(r() % live_first, salt));
+  }
+  for (uint64_t i = 0; i < samples; ++i) {
+    // Never added (indexes beyond 2^63)
+    fresh_fps += query(hash(r() | ((uint64_t)1 << 63), salt));
+  }
+
+  // A query matches if any live generation matches
+  double pass = 1.0;
+  for (uint64_t first = live_first; first < total; first += per_gen) {
+    double keys = (double)std::min(per_gen, total - first);
+    pass *= 1.0 - blocked_fp_rate_per_block(keys / cache_len_odd,
+                                            FP_RATE_CACHE_USABLE, k);
+  }
+  double model = 1.0 - pass;
+  std::cout << prog << " inserts: " << total
+    << " gens: " << window_gens
+    << " rotations: " << rotations
+    << " Minserts/s: " << total / insert_secs / 1e6
+    << " live_keys: " << live
+    << " live_query_ns: "
+    << (live > 0 ? std::chrono::duration<double>(t1 - t0).count() * 1e9 / samples : 0.0)
+    << " false_negatives: " << misses;
+  if (expired_n > 0) {
+    std::cout << " expired_fp_rate: " << (double)expired_fps / expired_n;
+  }
+  std::cout << " fresh_fp_rate: " << (double)fresh_fps / samples
+    << " model_fp_rate: " << model << std::endl;
+  return misses == 0 ? 0 : 1;
+#else
+  (void)r;
+  (void)max_total_queries;
+  std::cerr << prog << ": mode=window requires an IMPL with rotate()"
+            << std::endl;
+  return 2;
+#endif
+}
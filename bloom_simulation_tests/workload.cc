@@ -0,0 +1,195 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Included from foo.cc (before run_trial). Key workloads for the standard
+// benchmark, generated outside the timed regions:
+//   workload=uniform - added keys and negative queries from the RNG (the
+//                      original benchmark, same key sequence)
+//   workload=zipf    - like uniform, but positive queries pick added keys
+//                      with Zipf(zipf=, default 0.99) skew over rank
+//   workload=trace   - replay trace= FILE, native-endian uint64 keys: the
+//                      first max_n are added and all are queried in order
+//                      (wrapping around)
+// positive= is the fraction of queries for added keys (uniform and zipf;
+// default 0). For trace, whether a query is positive is looked up in the
+// added set, also outside the timed region. Bloom filters have no false
+// negatives, so false positives are true answers minus positive queries.
+
+#include <fstream>
+#include <vector>
+
+// Zipf distribution over ranks 1..n with exponent s, by rejection-
+// inversion (Hoermann and Derflinger), so O(1) space for any n
+class ZipfSampler {
+ public:
+  ZipfSampler(uint64_t n, double s) : n_(n), s_(s) {
+    h_integral_x1_ = h_integral(1.5) - 1.0;
+    h_integral_n_ = h_integral(n + 0.5);
+    s_const_ = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+  }
+
+  uint64_t sample(std::mt19937_64 &rng) {
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    for (;;) {
+      double u = h_integral_n_ + u01(rng) * (h_integral_x1_ - h_integral_n_);
+      double x = h_integral_inverse(u);
+      double k = std::floor(x + 0.5);
+      if (k < 1) {
+        k = 1;
+      } else if (k > n_) {
+        k = (double)n_;
+      }
+      if (k - x <= s_const_ || u >= h_integral(k + 0.5) - h(k)) {
+        return (uint64_t)k;
+      }
+    }
+  }
+
+ private:
+  // log1p(x)/x and expm1(x)/x, continuous at 0
+  static double helper1(double x) {
+    return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x / 2.0;
+  }
+  static double helper2(double x) {
+    return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x / 2.0;
+  }
+  double h(double x) const { return std::exp(-s_ * std::log(x)); }
+  double h_integral(double x) const {
+    double log_x = std::log(x);
+    return helper2((1.0 - s_) * log_x) * log_x;
+  }
+  double h_integral_inverse(double x) const {
+    double t = std::max(-1.0, x * (1.0 - s_));
+    return std::exp(helper1(t) * x);
+  }
+
+  uint64_t n_;
+  double s_;
+  double h_integral_x1_;
+  double h_integral_n_;
+  double s_const_;
+};
+
+struct Workload {
+  enum Kind { kUniform, kZipf, kTrace };
+  Kind kind = kUniform;
+  double positive = 0.0;
+  double zipf_s = 0.99;
+  // Decisions (positive or not, which key) use their own RNG, leaving the
+  // key sequence from r unchanged
+  std::mt19937_64 choice_rng;
+  std::unique_ptr<ZipfSampler> zipf;
+  std::vector<uint64_t> trace;
+  size_t trace_pos = 0;
+  // Hashes of keys added to the current structure, and a sorted copy for
+  // trace lookups
+  std::vector<uint64_t> added;
+  std::vector<uint64_t> added_sorted;
+
+  // Returns empty string on success, else an error
+  std::string init(const char *name, double pos, double s, const char *trace_file,
+                   uint64_t seed) {
+    positive = pos;
+    zipf_s = s;
+    choice_rng.seed(seed ^ 0x5bd1e9955bd1e995);
+    if (strcmp(name, "uniform") == 0) {
+      kind = kUniform;
+    } else if (strcmp(name, "zipf") == 0) {
+      kind = kZipf;
+      if (zipf_s <= 0) {
+        return "zipf= must be positive";
+      }
+    } else if (strcmp(name, "trace") == 0) {
+      kind = kTrace;
+      if (trace_file == nullptr) {
+        return "workload=trace requires trace=";
+      }
+      std::ifstream in(trace_file, std::ios::binary | std::ios::ate);
+      if (!in) {
+        return std::string("Unable to open ") + trace_file;
+      }
+      size_t bytes = (size_t)in.tellg();
+      trace.resize(bytes / sizeof(uint64_t));
+      in.seekg(0);
+      in.read(reinterpret_cast<char *>(trace.data()), trace.size() * sizeof(uint64_t));
+      if (trace.empty()) {
+        return std::string("Empty trace ") + trace_file;
+      }
+    } else {
+      return std::string("Unknown workload=") + name;
+    }
+    if (positive < 0 || positive > 1) {
+      return "positive= must be in [0, 1]";
+    }
+    return "";
+  }
+
+  void generate_adds(std::mt19937_64 &r, unsigned n) {
+    added.resize(n);
+    if (kind == kTrace) {
+      for (unsigned i = 0; i < n; ++i) {
+        added[i] = hash(trace[i % trace.size()]);
+      }
+      added_sorted = added;
+      std::sort(added_sorted.begin(), added_sorted.end());
+    } else {
+      for (unsigned i = 0; i < n; ++i) {
+        added[i] = hash(r());
+      }
+    }
+    if (kind == kZipf && !zipf) {
+      zipf.reset(new ZipfSampler(n, zipf_s));
+    }
+  }
+
+  // Fills out[0..count) with query hashes; returns how many are positive
+  int generate_queries(std::mt19937_64 &r, uint64_t *out, int count) {
+    int positives = 0;
+    if (kind == kTrace) {
+      for (int i = 0; i < count; ++i) {
+        out[i] = hash(trace[trace_pos]);
+        if (++trace_pos == trace.size()) trace_pos = 0;
+        positives += std::binary_search(added_sorted.begin(), added_sorted.end(), out[i]);
+      }
+      return positives;
+    }
+    if (positive == 0.0 || added.empty()) {
+      for (int i = 0; i < count; ++i) {
+        out[i] = hash(r());
+      }
+      return 0;
+    }
+    std::bernoulli_distribution is_positive(positive);
+    std::uniform_int_distribution<size_t> pick(0, added.size() - 1);
+    for (int i = 0; i < count; ++i) {
+      if (is_positive(choice_rng)) {
+        size_t idx = kind == kZipf ? zipf->sample(choice_rng) - 1 : pick(choice_rng);
+        out[i] = added[idx];
+        ++positives;
+      } else {
+        out[i] = hash(r());
+      }
+    }
+    return positives;
+  }
+};
@@ -0,0 +1,90 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Included from foo.cc. mode=wormcheck: verify the SIMD worm64
+// (worm_simd.cc) against scalar worm64, then compare throughput of
+// generating k positions per hash, scalar vs. SIMD, for the given number
+// of hashes (the queries argument).
+
+// Returns process exit code
+static int worm64x_check(const char *prog, uint64_t seed, int count) {
+#ifdef WORM64X_LANES
+  uint64_t mismatches = worm64x_self_check(seed, 100000);
+  if (mismatches != 0) {
+    std::cout << prog << " worm64x_self_check: FAIL mismatches: "
+              << mismatches << std::endl;
+    return 1;
+  }
+  count = count / WORM64X_LANES * WORM64X_LANES;
+  std::vector<uint64_t> hashes(count);
+  std::mt19937_64 rng(seed);
+  for (uint64_t &h : hashes) {
+    h = hash(rng());
+  }
+
+  uint64_t scalar_sum = 0;
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i) {
+    uint64_t h = hashes[i];
+    for (unsigned j = 0; j < k; ++j) {
+      scalar_sum += worm64(m_odd, /*in/out*/h);
+    }
+  }
+  std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+  alignas(64) uint64_t sums[WORM64X_LANES];
+  worm64x_vec a = worm64x_set1(m_odd);
+  worm64x_vec sum = worm64x_set1(0);
+  for (int i = 0; i < count; i += WORM64X_LANES) {
+    worm64x_vec h = worm64x_load(&hashes[i]);
+    for (unsigned j = 0; j < k; ++j) {
+#if WORM64X_LANES == 8
+      sum = _mm512_add_epi64(sum, worm64x_narrow(a, h));
+#else
+      sum = _mm256_add_epi64(sum, worm64x_narrow(a, h));
+#endif
+    }
+  }
+  std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+  worm64x_store(sums, sum);
+  uint64_t simd_sum = 0;
+  for (unsigned l = 0; l < WORM64X_LANES; ++l) {
+    simd_sum += sums[l];
+  }
+
+  double positions = (double)count * k;
+  double scalar_secs = std::chrono::duration<double>(t1 - t0).count();
+  double simd_secs = std::chrono::duration<double>(t2 - t1).count();
+  std::cout << prog << " worm64x_self_check: PASS lanes: " << WORM64X_LANES
+    << " scalar_Mpos/s: " << positions / scalar_secs / 1e6
+    << " simd_Mpos/s: " << positions / simd_secs / 1e6
+    << " speedup: " << scalar_secs / simd_secs
+    << " sums_match: " << (scalar_sum == simd_sum ? "yes" : "NO")
+    << std::endl;
+  return scalar_sum == simd_sum ? 0 : 1;
+#else
+  (void)seed;
+  (void)count;
+  std::cerr << prog << ": SIMD worm64 requires AVX2" << std::endl;
+  return 2;
+#endif
+}
@@ -0,0 +1,173 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Included from foo.cc. SIMD worm64: advance 4 (AVX2) or 8 (AVX-512F)
+// independent hash states at once, returning the upper words and leaving
+// the lower words in h, bit-identical to worm64() per lane. The 64x64->128
+// products are composed from 32x32->64 partial products (mul_epu32).
+// (AVX-512 IFMA multiplies 52-bit limbs, which does not compose into
+// exact 64-bit products more cheaply than this.)
+//
+// worm64x() takes any 64-bit ranges a; worm64x_narrow() requires every
+// a < 2^32 (true for the 32-bit sizes in foo.cc) and skips the two
+// products involving the upper half of a.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+static inline __m256i worm64x(__m256i a, __m256i &h) {
+  const __m256i lo32 = _mm256_set1_epi64x(0xffffffff);
+  __m256i a_hi = _mm256_srli_epi64(a, 32);
+  __m256i h_hi = _mm256_srli_epi64(h, 32);
+  __m256i p00 = _mm256_mul_epu32(a, h);
+  __m256i p01 = _mm256_mul_epu32(a, h_hi);
+  __m256i p10 = _mm256_mul_epu32(a_hi, h);
+  __m256i p11 = _mm256_mul_epu32(a_hi, h_hi);
+  // Middle 32-bit column with carries (at most 3 * (2^32 - 1))
+  __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(p00, 32),
+                                 _mm256_add_epi64(_mm256_and_si256(p01, lo32),
+                                                  _mm256_and_si256(p10, lo32)));
+  __m256i upper = _mm256_add_epi64(
+      _mm256_add_epi64(p11, _mm256_srli_epi64(mid, 32)),
+      _mm256_add_epi64(_mm256_srli_epi64(p01, 32), _mm256_srli_epi64(p10, 32)));
+  h = _mm256_or_si256(_mm256_slli_epi64(mid, 32), _mm256_and_si256(p00, lo32));
+  return upper;
+}
+
+static inline __m256i worm64x_narrow(__m256i a, __m256i &h) {
+  const __m256i lo32 = _mm256_set1_epi64x(0xffffffff);
+  __m256i p00 = _mm256_mul_epu32(a, h);
+  __m256i p01 = _mm256_mul_epu32(a, _mm256_srli_epi64(h, 32));
+  __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(p00, 32),
+                                 _mm256_and_si256(p01, lo32));
+  __m256i upper = _mm256_add_epi64(_mm256_srli_epi64(p01, 32),
+                                   _mm256_srli_epi64(mid, 32));
+  h = _mm256_or_si256(_mm256_slli_epi64(mid, 32), _mm256_and_si256(p00, lo32));
+  return upper;
+}
+#endif
+
+#if defined(__AVX512F__)
+// Zero-masked forms: the unmasked intrinsics pass an undefined merge source
+// that GCC 12 reports under -Wmaybe-uninitialized
+static inline __m512i worm64x_mul_(__m512i a, __m512i b) {
+  return _mm512_maskz_mul_epu32(0xff, a, b);
+}
+static inline __m512i worm64x_srli_(__m512i v, unsigned n) {
+  return _mm512_maskz_srli_epi64(0xff, v, n);
+}
+static inline __m512i worm64x_slli_(__m512i v, unsigned n) {
+  return _mm512_maskz_slli_epi64(0xff, v, n);
+}
+
+static inline __m512i worm64x(__m512i a, __m512i &h) {
+  const __m512i lo32 = _mm512_set1_epi64(0xffffffff);
+  __m512i a_hi = worm64x_srli_(a, 32);
+  __m512i h_hi = worm64x_srli_(h, 32);
+  __m512i p00 = worm64x_mul_(a, h);
+  __m512i p01 = worm64x_mul_(a, h_hi);
+  __m512i p10 = worm64x_mul_(a_hi, h);
+  __m512i p11 = worm64x_mul_(a_hi, h_hi);
+  __m512i mid = _mm512_add_epi64(worm64x_srli_(p00, 32),
+                                 _mm512_add_epi64(_mm512_and_si512(p01, lo32),
+                                                  _mm512_and_si512(p10, lo32)));
+  __m512i upper = _mm512_add_epi64(
+      _mm512_add_epi64(p11, worm64x_srli_(mid, 32)),
+      _mm512_add_epi64(worm64x_srli_(p01, 32), worm64x_srli_(p10, 32)));
+  h = _mm512_or_si512(worm64x_slli_(mid, 32), _mm512_and_si512(p00, lo32));
+  return upper;
+}
+
+static inline __m512i worm64x_narrow(__m512i a, __m512i &h) {
+  const __m512i lo32 = _mm512_set1_epi64(0xffffffff);
+  __m512i p00 = worm64x_mul_(a, h);
+  __m512i p01 = worm64x_mul_(a, worm64x_srli_(h, 32));
+  __m512i mid = _mm512_add_epi64(worm64x_srli_(p00, 32),
+                                 _mm512_and_si512(p01, lo32));
+  __m512i upper = _mm512_add_epi64(worm64x_srli_(p01, 32),
+                                   worm64x_srli_(mid, 32));
+  h = _mm512_or_si512(worm64x_slli_(mid, 32), _mm512_and_si512(p00, lo32));
+  return upper;
+}
+
+// Widest available
+#define WORM64X_LANES 8
+typedef __m512i worm64x_vec;
+static inline worm64x_vec worm64x_load(const uint64_t *p) {
+  return _mm512_loadu_si512(p);
+}
+static inline void worm64x_store(uint64_t *p, worm64x_vec v) {
+  _mm512_storeu_si512(p, v);
+}
+static inline worm64x_vec worm64x_set1(uint64_t v) {
+  return _mm512_set1_epi64((long long)v);
+}
+#elif defined(__AVX2__)
+#define WORM64X_LANES 4
+typedef __m256i worm64x_vec;
+static inline worm64x_vec worm64x_load(const uint64_t *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+static inline void worm64x_store(uint64_t *p, worm64x_vec v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+}
+static inline worm64x_vec worm64x_set1(uint64_t v) {
+  return _mm256_set1_epi64x((long long)v);
+}
+#endif
+
+#ifdef WORM64X_LANES
+// Compare worm64x and worm64x_narrow against scalar worm64 over chains
+// of random states and ranges. Returns number of mismatching lanes.
+static uint64_t worm64x_self_check(uint64_t seed, unsigned iterations) {
+  std::mt19937_64 rng(seed);
+  uint64_t mismatches = 0;
+  for (unsigned it = 0; it < iterations; ++it) {
+    alignas(64) uint64_t a[WORM64X_LANES], h[WORM64X_LANES];
+    alignas(64) uint64_t h_narrow[WORM64X_LANES], a_narrow[WORM64X_LANES];
+    for (unsigned l = 0; l < WORM64X_LANES; ++l) {
+      // Mix in edge values
+      a[l] = (it & 3) == 0 ? ~(uint64_t)l : rng();
+      a_narrow[l] = (it & 3) == 1 ? 0xffffffff - l : rng() >> 32;
+      h[l] = h_narrow[l] = (it & 3) == 2 ? ~(uint64_t)0 : rng();
+    }
+    worm64x_vec va = worm64x_load(a), vh = worm64x_load(h);
+    worm64x_vec van = worm64x_load(a_narrow), vhn = worm64x_load(h_narrow);
+    for (unsigned step = 0; step < 8; ++step) {
+      alignas(64) uint64_t up[WORM64X_LANES], lo[WORM64X_LANES];
+      alignas(64) uint64_t up_n[WORM64X_LANES], lo_n[WORM64X_LANES];
+      worm64x_store(up, worm64x(va, vh));
+      worm64x_store(lo, vh);
+      worm64x_store(up_n, worm64x_narrow(van, vhn));
+      worm64x_store(lo_n, vhn);
+      for (unsigned l = 0; l < WORM64X_LANES; ++l) {
+        uint64_t expect = worm64(a[l], h[l]);
+        mismatches += up[l] != expect || lo[l] != h[l];
+        expect = worm64(a_narrow[l], h_narrow[l]);
+        mismatches += up_n[l] != expect || lo_n[l] != h_narrow[l];
+      }
+    }
+  }
+  return mismatches;
+}
+#endif
@@ -1,6 +1,18 @@
+#include "worm_cycle.h"
 #include <stdint.h>
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
 
 // This program checks for cycles in 32-bit or 64-bit worm hashing
 // configurations appropriate for "standard" Bloom filters: generating up to
@@ -22,6 +34,25 @@
 // we can mechanically verify no cycles for any fixed range size up to
 // impractical values. See saved_partial_output_64.)
 
+// But we don't need brute force. For odd v, the multiplicative order of v
+// mod 2**w is a power of two, and the "lifting the exponent" lemma for p=2
+// says the 2-adic valuation of v**(2**j) - 1 is t + j - 1 for j >= 1, where
+// t is the 2-adic valuation of v**2 - 1. So (v != 1) has order 2**j with
+// j = max(1, w + 1 - t). It follows that the v with order <= 2**J are
+// exactly those with v === +/-1 (mod 2**(w-J)), which we can simply
+// enumerate. The "analytic" mode does that, reproducing saved_output_32 in
+// a blink and producing the complete table for 64-bit (saved_output_64).
+// The order computation is in worm_cycle.h for use by applications.
+
+// Spot checks against saved_output_32 and saved_output_64
+static_assert(!WormCycleSafe(32, 0x7ffffff, 32), "order 32");
+static_assert(WormCycleSafe(32, 0x7ffffff, 31), "order 32");
+static_assert(!WormCycleSafe(32, 0x40000001, 4), "order 4");
+static_assert(WormCycleSafe(32, 0x7fffffd, 32), "no cycle");
+static_assert(!WormCycleSafe(64, 0xf800000000000001, 32), "order 32");
+static_assert(WormCycleSafe(64, 0xfffffffffffffffd, 32), "no cycle");
+static_assert(WormCycleSafeRange(32, 0x8000001, 32) == 0x7fffffd, "adjust");
+
 void check32() {
   for (uint32_t v = 1; v != 0; v++) {
     uint32_t p = v;
@@ -56,7 +87,306 @@ void check64() {
   }
 }
 
+// For cross-validation of the analytic mode, the "scan" mode is the same
+// brute force as check32/check64 (odd v only, since even v can't cycle)
+// but sharded into chunks over threads, vectorized where available, and
+// recording progress in a checkpoint file so that a long 64-bit sweep can
+// be killed and resumed. Results are printed in v order, the same as
+// check32/check64 would; progress goes to stderr. After resuming, results
+// from chunks in flight when killed (past the checkpoint) may be printed
+// again.
+
+static const int kScanMaxK = 32;
+static const int kScanChunkLog2 = 26; // odd values per chunk
+
+struct ScanHit {
+  uint64_t v;
+  int i;
+};
+
+// Smallest 2 <= i <= kScanMaxK with v**i === 1 (mod 2**w), or 0
+template <typename T>
+static int first_cycle(T v) {
+  T p = v;
+  for (int i = 2; i <= kScanMaxK; i++) {
+    p *= v;
+    if (p == 1) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX512DQ__)
+static const int kLanes64 = 8;
+// Whether any lane of v0, v0+2, ... cycles
+static bool any_cycle64(uint64_t v0) {
+  const __m512i v = _mm512_add_epi64(_mm512_set1_epi64(v0),
+      _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14));
+  const __m512i one = _mm512_set1_epi64(1);
+  __m512i p = v;
+  __mmask8 any = 0;
+  for (int i = 2; i <= kScanMaxK; i++) {
+    p = _mm512_mullo_epi64(p, v);
+    any |= _mm512_cmpeq_epi64_mask(p, one);
+  }
+  return any != 0;
+}
+#elif defined(__AVX2__)
+static const int kLanes64 = 4;
+// Low 64 bits of 64x64 product per lane, from 32x32->64 products
+static inline __m256i mullo_epi64(__m256i a, __m256i b) {
+  __m256i lo = _mm256_mul_epu32(a, b);
+  __m256i cross = _mm256_add_epi64(
+      _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+      _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+  return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+static bool any_cycle64(uint64_t v0) {
+  const __m256i v = _mm256_add_epi64(_mm256_set1_epi64x(v0),
+                                     _mm256_setr_epi64x(0, 2, 4, 6));
+  const __m256i one = _mm256_set1_epi64x(1);
+  __m256i p = v;
+  __m256i any = _mm256_setzero_si256();
+  for (int i = 2; i <= kScanMaxK; i++) {
+    p = mullo_epi64(p, v);
+    any = _mm256_or_si256(any, _mm256_cmpeq_epi64(p, one));
+  }
+  return !_mm256_testz_si256(any, any);
+}
+#else
+static const int kLanes64 = 1;
+static bool any_cycle64(uint64_t v0) {
+  return first_cycle<uint64_t>(v0) != 0;
+}
+#endif
+
+#if defined(__AVX512F__)
+static const int kLanes32 = 16;
+static bool any_cycle32(uint32_t v0) {
+  const __m512i v = _mm512_add_epi32(_mm512_set1_epi32(v0),
+      _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                        16, 18, 20, 22, 24, 26, 28, 30));
+  const __m512i one = _mm512_set1_epi32(1);
+  __m512i p = v;
+  __mmask16 any = 0;
+  for (int i = 2; i <= kScanMaxK; i++) {
+    p = _mm512_mullo_epi32(p, v);
+    any |= _mm512_cmpeq_epi32_mask(p, one);
+  }
+  return any != 0;
+}
+#elif defined(__AVX2__)
+static const int kLanes32 = 8;
+static bool any_cycle32(uint32_t v0) {
+  const __m256i v = _mm256_add_epi32(_mm256_set1_epi32(v0),
+      _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14));
+  const __m256i one = _mm256_set1_epi32(1);
+  __m256i p = v;
+  __m256i any = _mm256_setzero_si256();
+  for (int i = 2; i <= kScanMaxK; i++) {
+    p = _mm256_mullo_epi32(p, v);
+    any = _mm256_or_si256(any, _mm256_cmpeq_epi32(p, one));
+  }
+  return !_mm256_testz_si256(any, any);
+}
+#else
+static const int kLanes32 = 1;
+static bool any_cycle32(uint32_t v0) {
+  return first_cycle<uint32_t>(v0) != 0;
+}
+#endif
+
+// Checks the odd values of chunk c, appending hits in v order
+static void scan_chunk(int w, uint64_t c, std::vector<ScanHit> &hits) {
+  uint64_t v = (c << (kScanChunkLog2 + 1)) | 1;
+  uint64_t v_end = v + ((uint64_t)2 << kScanChunkLog2); // may wrap to 0
+  if (w == 32) {
+    for (; v != v_end; v += 2 * kLanes32) {
+      if (any_cycle32((uint32_t)v)) {
+        // Rare; find which lanes with scalar code
+        for (int j = 0; j < kLanes32; j++) {
+          int i = first_cycle<uint32_t>((uint32_t)(v + 2 * j));
+          if (i) {
+            hits.push_back(ScanHit{v + 2 * j, i});
+          }
+        }
+      }
+    }
+  } else {
+    for (; v != v_end; v += 2 * kLanes64) {
+      if (any_cycle64(v)) {
+        for (int j = 0; j < kLanes64; j++) {
+          int i = first_cycle<uint64_t>(v + 2 * j);
+          if (i) {
+            hits.push_back(ScanHit{v + 2 * j, i});
+          }
+        }
+      }
+    }
+  }
+}
+
+static bool read_checkpoint(const char *fname, int w, uint64_t &next_chunk) {
+  std::ifstream in(fname);
+  if (!in) {
+    return false;
+  }
+  int file_w = 0;
+  std::string tag;
+  in >> tag >> file_w >> next_chunk;
+  if (!in || tag != "scan" || file_w != w) {
+    std::cerr << "Bad checkpoint file " << fname << std::endl;
+    std::exit(2);
+  }
+  return true;
+}
+
+static void write_checkpoint(const char *fname, int w, uint64_t next_chunk) {
+  std::string tmp = std::string(fname) + ".tmp";
+  {
+    std::ofstream out(tmp.c_str());
+    out << "scan " << w << " " << next_chunk << std::endl;
+    if (!out) {
+      std::cerr << "Unable to write " << tmp << std::endl;
+      std::exit(1);
+    }
+  }
+  if (std::rename(tmp.c_str(), fname) != 0) {
+    std::cerr << "Unable to rename " << tmp << std::endl;
+    std::exit(1);
+  }
+}
+
+// Scans odd v < 2**limit_log2 with num_threads threads
+void check_scan(int w, int num_threads, const char *checkpoint_fname,
+                int limit_log2) {
+  const uint64_t end_chunk =
+      (uint64_t)1 << (std::min(limit_log2, w) - 1 - kScanChunkLog2);
+  uint64_t start_chunk = 0;
+  if (checkpoint_fname && read_checkpoint(checkpoint_fname, w, start_chunk)) {
+    std::cerr << "Resuming from chunk " << start_chunk << std::endl;
+  }
+
+  std::mutex mutex;
+  std::atomic<uint64_t> next_chunk{start_chunk};
+  // Completed chunks not yet printed, and first chunk not yet printed
+  std::map<uint64_t, std::vector<ScanHit>> pending;
+  uint64_t printed_through = start_chunk;
+  auto last_checkpoint = std::chrono::steady_clock::now();
+
+  auto worker = [&]() {
+    for (;;) {
+      uint64_t c = next_chunk++;
+      if (c >= end_chunk) {
+        break;
+      }
+      std::vector<ScanHit> hits;
+      scan_chunk(w, c, hits);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      pending[c].swap(hits);
+      bool advanced = false;
+      for (auto it = pending.begin();
+           it != pending.end() && it->first == printed_through;
+           it = pending.erase(it)) {
+        for (const ScanHit &h : it->second) {
+          std::cout << "0x" << std::hex << h.v << std::dec
+                    << " ** " << h.i
+                    << " === 1 (mod 2**" << w << ")" << '\n';
+        }
+        printed_through++;
+        advanced = true;
+      }
+      auto now = std::chrono::steady_clock::now();
+      if (advanced && (now - last_checkpoint > std::chrono::seconds(10) ||
+                       printed_through == end_chunk)) {
+        std::cout << std::flush;
+        if (checkpoint_fname) {
+          write_checkpoint(checkpoint_fname, w, printed_through);
+        }
+        last_checkpoint = now;
+        uint64_t v_done = printed_through << (kScanChunkLog2 + 1);
+        if (w == 32) {
+          std::cerr << "(" << (v_done >> 23) << "MB Bloom filter)" << std::endl;
+        } else {
+          std::cerr << "(" << (v_done >> 33) << "GB Bloom filter)" << std::endl;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  std::cout << std::flush;
+}
+
+// Same output as check32/check64 would give (if they finished) for
+// 2 <= i <= max_k
+void check_analytic(int w, int max_k) {
+  int max_j = 0;
+  while (((uint64_t)2 << max_j) <= (uint64_t)max_k) {
+    max_j++;
+  }
+  if (max_j > w - 2) {
+    // Not interesting
+    max_j = w - 2;
+  }
+  uint64_t mask = w == 64 ? ~(uint64_t)0 : ((uint64_t)1 << w) - 1;
+  uint64_t step = (uint64_t)1 << (w - max_j);
+  std::vector<uint64_t> candidates;
+  for (uint64_t c = 0; c < ((uint64_t)1 << max_j); c++) {
+    candidates.push_back(c * step + 1);
+    candidates.push_back(((c + 1) * step - 1) & mask);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (uint64_t v : candidates) {
+    int order = 1 << WormOrderLog2(w, v);
+    // Smallest i >= 2 with v**i === 1
+    int i = std::max(order, 2);
+    if (i <= max_k) {
+      std::cout << "0x" << std::hex << v << std::dec
+                << " ** " << i
+                << " === 1 (mod 2**" << w << ")" << std::endl;
+    }
+  }
+}
+
 int main(int argc, char *argv[]) {
+  if (argc > 2 && 0 == strcmp(argv[1], "analytic")) {
+    int w = std::atoi(argv[2]);
+    int max_k = argc > 3 ? std::atoi(argv[3]) : 32;
+    // About 2 * max_k candidates are listed and checked
+    if (w < 3 || w > 64 || max_k < 2 || max_k > (1 << 24)) {
+      std::cerr << "Word size must be 3 to 64 and max k 2 to 2**24" << std::endl;
+      return 2;
+    }
+    check_analytic(w, max_k);
+    return 0;
+  }
+  if (argc > 3 && 0 == strcmp(argv[1], "scan")) {
+    int w = std::atoi(argv[2]);
+    int num_threads = std::atoi(argv[3]);
+    const char *checkpoint_fname = argc > 4 ? argv[4] : nullptr;
+    int limit_log2 = argc > 5 ? std::atoi(argv[5]) : 64;
+    if ((w != 32 && w != 64) || num_threads < 1 ||
+        limit_log2 < kScanChunkLog2 + 1) {
+      std::cerr << "Bad scan arguments" << std::endl;
+      return 2;
+    }
+    check_scan(w, num_threads, checkpoint_fname, limit_log2);
+    return 0;
+  }
   if (argc > 1 && 0 == strcmp(argv[1], "32")) {
     check32();
     return 0;
@@ -65,6 +395,8 @@ int main(int argc, char *argv[]) {
     return 0;
   } else {
     std::cerr << "Usage: " << argv[0] << " {32|64} | tee saved_output" << std::endl;
+    std::cerr << "   or: " << argv[0] << " analytic {32|64} [max_k] | tee saved_output" << std::endl;
+    std::cerr << "   or: " << argv[0] << " scan {32|64} threads [checkpoint_file [limit_log2]] | tee -a saved_output" << std::endl;
     return 2;
   }
 }
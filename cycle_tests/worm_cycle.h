@@ -0,0 +1,77 @@
+/*
+Copyright (c) Peter C. Dillinger
+Copyright (c) Facebook, Inc. and its affiliates.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// Cycle hazard check for worm hashing with a fixed range (e.g. standard
+// Bloom filter with k values over m_odd bits). With word size w, the carried
+// hash after i steps is h * m_odd**i (mod 2**w), so values repeat if
+// m_odd**i === 1 (mod 2**w) for some 1 <= i <= k. The multiplicative order
+// of odd m_odd is a power of two determined by the 2-adic valuation of
+// m_odd**2 - 1 (see check_fixed_sizes.cc), so this is cheap, and usable in
+// constant expressions (C++11 constexpr).
+
+constexpr uint64_t WormWordMask(unsigned word_bits) {
+  return word_bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << word_bits) - 1;
+}
+
+// Requires x != 0
+constexpr unsigned WormTrailingZeros(uint64_t x) {
+  return (x & 1) ? 0 : 1 + WormTrailingZeros(x >> 1);
+}
+
+constexpr unsigned WormOrderLog2FromSquareMinus1(unsigned word_bits,
+                                                 uint64_t sq_minus_1) {
+  return sq_minus_1 == 0 ? 1
+      : word_bits + 1 - WormTrailingZeros(sq_minus_1) > 1
+          ? word_bits + 1 - WormTrailingZeros(sq_minus_1)
+          : 1;
+}
+
+// log2 of the multiplicative order of odd m_odd mod 2**word_bits
+// (3 <= word_bits <= 64)
+constexpr unsigned WormOrderLog2(unsigned word_bits, uint64_t m_odd) {
+  return (m_odd & WormWordMask(word_bits)) == 1 ? 0
+      : WormOrderLog2FromSquareMinus1(
+            word_bits, (m_odd * m_odd - 1) & WormWordMask(word_bits));
+}
+
+// Whether generating k values with worm hashing over range m_odd (word size
+// word_bits) is free of cycles. Conservative in that a cycle only closing
+// after the k-th value (order == k) also counts as unsafe. Even ranges are
+// never safe (not regenerative).
+constexpr bool WormCycleSafe(unsigned word_bits, uint64_t m_odd, unsigned k) {
+  return (m_odd & 1) != 0 &&
+         ((uint64_t)1 << WormOrderLog2(word_bits, m_odd)) > k;
+}
+
+// Largest odd range <= m_odd (odd) that is WormCycleSafe, or 1 if none.
+// Unsafe ranges are +/-1 modulo a large power of two, so this takes at most
+// a couple of steps for practical k.
+constexpr uint64_t WormCycleSafeRange(unsigned word_bits, uint64_t m_odd,
+                                      unsigned k) {
+  return m_odd <= 1 || WormCycleSafe(word_bits, m_odd, k) ? m_odd
+      : WormCycleSafeRange(word_bits, m_odd - 2, k);
+}
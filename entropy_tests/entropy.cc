@@ -27,11 +27,19 @@ SOFTWARE.
 #define uint128_t __uint128_t
 #include <memory>
 #include <algorithm>
-#include <set>
 #include <iostream>
 #include <random>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
+#include <sys/mman.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 static uint64_t hash(uint64_t v, uint64_t seed = 0) {
   return XXH64(&v, sizeof(v), seed);
@@ -46,6 +54,16 @@ static uint32_t mix32(uint32_t v) {
   return v;
 }
 
+// Bijective (murmur3 finalizer)
+static uint64_t mix64(uint64_t v) {
+  v ^= v >> 33;
+  v *= 0xff51afd7ed558ccdULL;
+  v ^= v >> 33;
+  v *= 0xc4ceb9fe1a85ec53ULL;
+  v ^= v >> 33;
+  return v;
+}
+
 static uint32_t nearest_prime_helper(uint32_t odd, uint32_t sqrt_upper_bound) {
   redo:
   for (uint32_t i = 3; i < sqrt_upper_bound; i += 2) {
@@ -68,215 +86,557 @@ static uint32_t nearest_prime(uint32_t v) {
   return nearest_prime_helper(v, sqrt_upper_bound);
 }
 
-int main(int argc, char *argv[]) {
-  if (argc < 2) {
-    std::cerr << "Not enough arguments" << std::endl;
-    return 2;
+// Number of values that are a repeat of an earlier value (same as number
+// of failed std::set inserts), by sorting and comparing neighbors
+template <typename T>
+static int count_repeats(std::vector<T> &vals) {
+  std::sort(vals.begin(), vals.end());
+  int repeats = 0;
+  for (size_t i = 1; i < vals.size(); i++) {
+    repeats += vals[i] == vals[i - 1];
   }
-  int seed = std::atoi(argv[1]);
-  std::mt19937_64 r(seed);
+  return repeats;
+}
 
-  std::vector<bool> seen;
-  std::vector<bool> seen_xtra;
-  std::vector<bool> seen_inter;
-  std::vector<bool> seen_inter_xtra;
-  std::set<uint64_t> seen_sparse;
-  std::set<uint64_t> seen_sparse_xtra;
-  for (int testno = 0; ; testno++) {
-    uint32_t start_val = r();
-    uint32_t start_val_incr = r() | 1;
-
-    {
-      // Test that (various ranges within each test)
-      // Going just over with multiples preserves uniqueness (entropy)
-      // Using every other result ("interference") is close to that
-
-      const uint32_t max_iterations = 5000000;
-      std::vector<uint32_t> configuration;
-      std::vector<uint32_t> interference;
-      uint64_t product = 1;
-      bool last = false;
-      for (; !last;) {
-        int inner_bits = ((((uint64_t)r()) >> 5) * 31) >> 59;
-        uint32_t next_odd = ((uint32_t)r() & ((2 << inner_bits) - 1)) | (2 << inner_bits) | 1;
-        //next_odd = nearest_prime(next_odd);
-        if (product * next_odd > ((uint64_t)1 << 32)) {
-          next_odd = (((uint64_t)1 << 32) / product + 1) | 1;
-          last = true;
-        }
-        configuration.push_back(next_odd);
-        product *= next_odd;
-
-        inner_bits = ((((uint64_t)r()) >> 5) * 31) >> 59;
-        next_odd = ((uint32_t)r() & ((2 << inner_bits) - 1)) | (2 << inner_bits) | 1;
-        //next_odd = nearest_prime(next_odd);
-        interference.push_back(next_odd);
+// Word-packed bitmap in page-aligned anonymous memory, reused across tests
+// so that up to ~2**33 bits are not re-allocated each time. No bounds
+// checking on test_and_set.
+class Bitmap {
+ public:
+  Bitmap() {}
+  Bitmap(const Bitmap &) = delete;
+  Bitmap &operator=(const Bitmap &) = delete;
+  ~Bitmap() {
+    if (words_ != nullptr) {
+      munmap(words_, mapped_bytes_);
+    }
+  }
+
+  // All bits zero, with room for nbits
+  void reset(uint64_t nbits) {
+    size_t bytes = ((nbits + 63) / 64 * 8 + kPageSize - 1) & ~(kPageSize - 1);
+    if (bytes > mapped_bytes_) {
+      if (words_ != nullptr) {
+        munmap(words_, mapped_bytes_);
       }
-      interference[0] = 1;
-      seen.clear(); seen.resize(product);
-      seen_xtra.clear(); seen_xtra.resize(product);
-      seen_inter.clear(); seen_inter.resize(product);
-      seen_inter_xtra.clear(); seen_inter_xtra.resize(product);
-      int collisions = 0;
-      int collisions_xtra = 0;
-      int collisions_inter = 0;
-      int collisions_inter_xtra = 0;
-      for (uint32_t iterations = 0; iterations < max_iterations; iterations++) {
-        uint32_t cur = mix32(start_val);
-        uint64_t composite = 0;
-        uint32_t cur_xtra = cur;
-        uint64_t composite_xtra = 0;
-        uint32_t cur_inter = cur;
-        uint64_t composite_inter = 0;
-        uint32_t cur_inter_xtra = cur;
-        uint64_t composite_inter_xtra = 0;
-        for (unsigned i = 0; i < configuration.size(); i++) {
-          uint32_t p = configuration[i];
-          uint64_t p64 = p;
-
-          uint32_t upper = (cur * p64) >> 32;
-          composite = composite * p + upper;
-          cur = cur * p;
-
-          upper = (cur_xtra * p64) >> 32;
-          composite_xtra = composite_xtra * p + upper;
-          cur_xtra = cur_xtra * p + upper;
-
-          cur_inter *= interference[i];
-          upper = (cur_inter * p64) >> 32;
-          composite_inter = composite_inter * p + upper;
-          cur_inter = cur_inter * p;
-
-          cur_inter_xtra *= interference[i];
-          upper = (cur_inter_xtra * p64) >> 32;
-          composite_inter_xtra = composite_inter_xtra * p + upper;
-          cur_inter_xtra = cur_inter_xtra * p + upper;
-        }
-
-        if (seen.at(composite)) {
-          collisions++;
-        } else {
-          seen[composite] = true;
-        }
-        if (seen_xtra.at(composite_xtra)) {
-          collisions_xtra++;
-        } else {
-          seen_xtra[composite_xtra] = true;
-        }
-        if (seen_inter.at(composite_inter)) {
-          collisions_inter++;
-        } else {
-          seen_inter[composite_inter] = true;
-        }
-        if (seen_inter_xtra.at(composite_inter_xtra)) {
-          collisions_inter_xtra++;
-        } else {
-          seen_inter_xtra[composite_inter_xtra] = true;
-        }
-
-        start_val += start_val_incr; // overflow ok
+      void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (p == MAP_FAILED) {
+        std::cerr << "mmap of " << bytes << " bytes failed" << std::endl;
+        std::abort();
       }
+#ifdef MADV_HUGEPAGE
+      // Fewer TLB misses on random access; ignore failure
+      madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+      words_ = static_cast<uint64_t *>(p);
+      mapped_bytes_ = bytes;
+    } else if (dirty_bytes_ >= kDropThreshold) {
+      // Give pages back; they read as zero on next touch
+      madvise(words_, dirty_bytes_, MADV_DONTNEED);
+    } else {
+      memset(words_, 0, dirty_bytes_);
+    }
+    dirty_bytes_ = bytes;
+  }
 
-      std::cout << "Various#" << testno << ": ";
-      for (unsigned i = 0; i < configuration.size(); i++) {
-        std::cout << "(" << interference[i] << "*)"
-                  << configuration[i];
-        if (i + 1 < configuration.size()) {
-          std::cout << "*";
-        } else {
-          std::cout << " ";
-        }
-      }
-      std::cout << "(" << product / 4294967296.0 << ") -> " << collisions << " coll, "
-                << collisions_xtra << " xtra, "
-                << collisions_inter << " inter, "
-                << collisions_inter_xtra << " inter_xtra"
-                << std::endl;
-
-      double position = 0.0;
-      std::cout << "          ";
-      for (unsigned i = 0; i < configuration.size(); i++) {
-        position += log2(interference[i]);
-        std::cout << "[" << position;
-        position += log2(configuration[i]);
-        std::cout << "," << position << "]";
+  // Sets the bit, returning whether it was already set
+  bool test_and_set(uint64_t i) {
+    uint64_t &word = words_[i >> 6];
+    uint64_t bit = (uint64_t)1 << (i & 63);
+    bool old = (word & bit) != 0;
+    word |= bit;
+    return old;
+  }
+
+ private:
+  static const size_t kPageSize = 4096;
+  static const size_t kDropThreshold = 64 << 20;
+  uint64_t *words_ = nullptr;
+  size_t mapped_bytes_ = 0;
+  // Prefix that may have non-zero bits
+  size_t dirty_bytes_ = 0;
+};
+
+// Reusable memory for one thread running tests
+struct Workspace {
+  Bitmap seen;
+  Bitmap seen_xtra;
+  Bitmap seen_inter;
+  Bitmap seen_inter_xtra;
+  std::vector<uint64_t> seen_sparse;
+  std::vector<uint64_t> seen_sparse_xtra;
+  std::vector<uint128_t> sampled[4];
+};
+
+// Collision totals grouped by configuration "shape" (number of ranges for
+// Various#, power for Same#), for the merged report of a parallel run.
+struct Stats {
+  struct Totals {
+    int tests = 0;
+    int64_t coll[4] = {0, 0, 0, 0};
+    int64_t max_coll[4] = {0, 0, 0, 0};
+  };
+  std::map<unsigned, Totals> by_shape;
+
+  void add(unsigned shape, int64_t c0, int64_t c1, int64_t c2 = 0,
+           int64_t c3 = 0) {
+    Totals &t = by_shape[shape];
+    int64_t c[4] = {c0, c1, c2, c3};
+    t.tests++;
+    for (int i = 0; i < 4; i++) {
+      t.coll[i] += c[i];
+      t.max_coll[i] = std::max(t.max_coll[i], c[i]);
+    }
+  }
+
+  void merge(const Stats &other) {
+    for (auto &e : other.by_shape) {
+      Totals &t = by_shape[e.first];
+      t.tests += e.second.tests;
+      for (int i = 0; i < 4; i++) {
+        t.coll[i] += e.second.coll[i];
+        t.max_coll[i] = std::max(t.max_coll[i], e.second.max_coll[i]);
       }
-      std::cout << std::endl;
     }
+  }
 
-    {
-      // And test that (various ranges across tests)
-      // Using same range and losing order meets entropy expectation
-      // TODO? Pairwise values meet expectation
-
-      const uint32_t max_iterations = 1000000;
-      int inner_bits = ((((uint64_t)r()) >> 5) * 16) >> 59;
-      uint32_t multiplicand = ((uint32_t)r() & ((2 << inner_bits) - 1)) | (2 << inner_bits) | 1;
-      //multiplicand = nearest_prime(multiplicand);
-      uint32_t power = 1;
-      uint64_t product = multiplicand;
-      uint64_t rep = ((uint64_t)1 << 32);
-      while (product < ((uint64_t)1 << 32)) {
-        power++;
-        rep *= power;
-        product *= multiplicand;
+  void print(std::ostream &out, const char *label, const char *shape_name,
+             const char *const names[], int count) const {
+    for (auto &e : by_shape) {
+      const Totals &t = e.second;
+      out << label << " " << shape_name << "=" << e.first
+          << " tests=" << t.tests << " ->";
+      for (int i = 0; i < count; i++) {
+        out << " " << names[i] << " mean " << (double)t.coll[i] / t.tests
+            << " max " << t.max_coll[i] << (i + 1 < count ? "," : "");
       }
+      out << '\n';
+    }
+  }
+};
+
+static void various_test(std::mt19937_64 &r, int testno, uint32_t &start_val,
+                         uint32_t start_val_incr, Workspace &ws,
+                         std::ostream &out, Stats &stats) {
+  // Test that (various ranges within each test)
+  // Going just over with multiples preserves uniqueness (entropy)
+  // Using every other result ("interference") is close to that
+
+  const uint32_t max_iterations = 5000000;
+  std::vector<uint32_t> configuration;
+  std::vector<uint32_t> interference;
+  uint64_t product = 1;
+  bool last = false;
+  for (; !last;) {
+    int inner_bits = ((((uint64_t)r()) >> 5) * 31) >> 59;
+    uint32_t next_odd = ((uint32_t)r() & ((2 << inner_bits) - 1)) | (2 << inner_bits) | 1;
+    //next_odd = nearest_prime(next_odd);
+    if (product * next_odd > ((uint64_t)1 << 32)) {
+      next_odd = (((uint64_t)1 << 32) / product + 1) | 1;
+      last = true;
+    }
+    configuration.push_back(next_odd);
+    product *= next_odd;
+
+    inner_bits = ((((uint64_t)r()) >> 5) * 31) >> 59;
+    next_odd = ((uint32_t)r() & ((2 << inner_bits) - 1)) | (2 << inner_bits) | 1;
+    //next_odd = nearest_prime(next_odd);
+    interference.push_back(next_odd);
+  }
+  interference[0] = 1;
+  ws.seen.reset(product);
+  ws.seen_xtra.reset(product);
+  ws.seen_inter.reset(product);
+  ws.seen_inter_xtra.reset(product);
+  int collisions = 0;
+  int collisions_xtra = 0;
+  int collisions_inter = 0;
+  int collisions_inter_xtra = 0;
+  for (uint32_t iterations = 0; iterations < max_iterations; iterations++) {
+    uint32_t cur = mix32(start_val);
+    uint64_t composite = 0;
+    uint32_t cur_xtra = cur;
+    uint64_t composite_xtra = 0;
+    uint32_t cur_inter = cur;
+    uint64_t composite_inter = 0;
+    uint32_t cur_inter_xtra = cur;
+    uint64_t composite_inter_xtra = 0;
+    for (unsigned i = 0; i < configuration.size(); i++) {
+      uint32_t p = configuration[i];
+      uint64_t p64 = p;
+
+      uint32_t upper = (cur * p64) >> 32;
+      composite = composite * p + upper;
+      cur = cur * p;
+
+      upper = (cur_xtra * p64) >> 32;
+      composite_xtra = composite_xtra * p + upper;
+      cur_xtra = cur_xtra * p + upper;
+
+      cur_inter *= interference[i];
+      upper = (cur_inter * p64) >> 32;
+      composite_inter = composite_inter * p + upper;
+      cur_inter = cur_inter * p;
+
+      cur_inter_xtra *= interference[i];
+      upper = (cur_inter_xtra * p64) >> 32;
+      composite_inter_xtra = composite_inter_xtra * p + upper;
+      cur_inter_xtra = cur_inter_xtra * p + upper;
+    }
+
+    collisions += ws.seen.test_and_set(composite);
+    collisions_xtra += ws.seen_xtra.test_and_set(composite_xtra);
+    collisions_inter += ws.seen_inter.test_and_set(composite_inter);
+    collisions_inter_xtra += ws.seen_inter_xtra.test_and_set(composite_inter_xtra);
+
+    start_val += start_val_incr; // overflow ok
+  }
 
-      seen_sparse.clear();
-      seen_sparse_xtra.clear();
-      std::vector<uint32_t> vals(power);
-      int collisions = 0;
-      int collisions_xtra = 0;
-      for (uint32_t iterations = 0; iterations < max_iterations; iterations++) {
-        uint32_t cur = mix32(start_val);
-        for (unsigned i = 0; i < power; i++) {
-          vals[i] = ((uint64_t)cur * multiplicand) >> 32;
-          cur *= multiplicand;
-        }
-
-        std::sort(vals.begin(), vals.end());
-
-        uint64_t composite = 0;
-        for (unsigned i = 0; i < power; i++) {
-          composite = composite * multiplicand + vals[i];
-        }
-
-        if (seen_sparse.count(composite) > 0) {
-          collisions++;
-        } else {
-          seen_sparse.insert(composite);
-        }
+  out << "Various#" << testno << ": ";
+  for (unsigned i = 0; i < configuration.size(); i++) {
+    out << "(" << interference[i] << "*)"
+        << configuration[i];
+    if (i + 1 < configuration.size()) {
+      out << "*";
+    } else {
+      out << " ";
+    }
+  }
+  out << "(" << product / 4294967296.0 << ") -> " << collisions << " coll, "
+      << collisions_xtra << " xtra, "
+      << collisions_inter << " inter, "
+      << collisions_inter_xtra << " inter_xtra"
+      << '\n';
+
+  stats.add(configuration.size(), collisions, collisions_xtra,
+            collisions_inter, collisions_inter_xtra);
+
+  double position = 0.0;
+  out << "          ";
+  for (unsigned i = 0; i < configuration.size(); i++) {
+    position += log2(interference[i]);
+    out << "[" << position;
+    position += log2(configuration[i]);
+    out << "," << position << "]";
+  }
+  out << '\n';
+}
+
+static void same_test(std::mt19937_64 &r, int testno, uint32_t &start_val,
+                      uint32_t start_val_incr, Workspace &ws,
+                      std::ostream &out, Stats &stats) {
+  // And test that (various ranges across tests)
+  // Using same range and losing order meets entropy expectation
+  // TODO? Pairwise values meet expectation
+
+  const uint32_t max_iterations = 1000000;
+  int inner_bits = ((((uint64_t)r()) >> 5) * 16) >> 59;
+  uint32_t multiplicand = ((uint32_t)r() & ((2 << inner_bits) - 1)) | (2 << inner_bits) | 1;
+  //multiplicand = nearest_prime(multiplicand);
+  uint32_t power = 1;
+  uint64_t product = multiplicand;
+  uint64_t rep = ((uint64_t)1 << 32);
+  while (product < ((uint64_t)1 << 32)) {
+    power++;
+    rep *= power;
+    product *= multiplicand;
+  }
+
+  ws.seen_sparse.clear();
+  ws.seen_sparse.reserve(max_iterations);
+  ws.seen_sparse_xtra.clear();
+  ws.seen_sparse_xtra.reserve(max_iterations);
+  std::vector<uint32_t> vals(power);
+  for (uint32_t iterations = 0; iterations < max_iterations; iterations++) {
+    uint32_t cur = mix32(start_val);
+    for (unsigned i = 0; i < power; i++) {
+      vals[i] = ((uint64_t)cur * multiplicand) >> 32;
+      cur *= multiplicand;
+    }
+
+    std::sort(vals.begin(), vals.end());
+
+    uint64_t composite = 0;
+    for (unsigned i = 0; i < power; i++) {
+      composite = composite * multiplicand + vals[i];
+    }
+
+    ws.seen_sparse.push_back(composite);
 
 	// xtra
-        cur = mix32(start_val);
-        for (unsigned i = 0; i < power; i++) {
-          uint32_t upper = ((uint64_t)cur * multiplicand) >> 32;
-          vals[i] = upper;
-          cur = cur * multiplicand + upper;
-        }
-
-        std::sort(vals.begin(), vals.end());
-
-        composite = 0;
-        for (unsigned i = 0; i < power; i++) {
-          composite = composite * multiplicand + vals[i];
-        }
-
-        if (seen_sparse_xtra.count(composite) > 0) {
-          collisions_xtra++;
-        } else {
-          seen_sparse_xtra.insert(composite);
-        }
-
-        start_val += start_val_incr; // overflow ok
+    cur = mix32(start_val);
+    for (unsigned i = 0; i < power; i++) {
+      uint32_t upper = ((uint64_t)cur * multiplicand) >> 32;
+      vals[i] = upper;
+      cur = cur * multiplicand + upper;
+    }
+
+    std::sort(vals.begin(), vals.end());
+
+    composite = 0;
+    for (unsigned i = 0; i < power; i++) {
+      composite = composite * multiplicand + vals[i];
+    }
+
+    ws.seen_sparse_xtra.push_back(composite);
+
+    start_val += start_val_incr; // overflow ok
+  }
+
+  int collisions = count_repeats(ws.seen_sparse);
+  int collisions_xtra = count_repeats(ws.seen_sparse_xtra);
+
+  stats.add(power, collisions, collisions_xtra);
+
+  out << "Same#" << testno << ": "
+      << multiplicand << "**" << power << " "
+      << "(" << log2(product) << " bits vs. " << log2(rep) << ")"
+      << " -> " << collisions << " coll, "
+      << collisions_xtra << " xtra" << '\n';
+}
+
+// 64-bit version of Various#. Product of ranges just over 2**64 means
+// composites need up to 65+ bits, and there is no hope of a bitmap over that
+// space, so collisions are estimated by sampling: a composite is kept only
+// if a hash of it (deterministic, so repeats of a composite are sampled
+// together; not a bijection, as it folds 128 bits to 64) falls in the lowest
+// 1/2**sample_bits of hash values. Exact repeat counting over the kept
+// composites, scaled by 2**sample_bits, estimates the total. Memory is
+// bounded by keeping about 2**22 composites per variant regardless of
+// iteration count.
+//
+// For reference, the output includes the collisions expected from
+// uniformly random composites over the product range, n**2 / (2 * product)
+// for n iterations. That is far below 1 (about 1/32 at 2**30 iterations),
+// and a sampled estimate is 0 or at least 2**sample_bits, so this test only
+// detects gross loss of range, not the subtle shortfalls Various# can see.
+static void various64_test(std::mt19937_64 &r, int testno, uint64_t &start_val,
+                           uint64_t start_val_incr, int log2_iterations,
+                           Workspace &ws, std::ostream &out, Stats &stats) {
+  const uint64_t max_iterations = (uint64_t)1 << log2_iterations;
+  const int sample_bits = std::max(0, log2_iterations - 22);
+  std::vector<uint64_t> configuration;
+  std::vector<uint64_t> interference;
+  uint128_t product = 1;
+  const uint128_t two_to_64 = (uint128_t)1 << 64;
+  bool last = false;
+  for (; !last;) {
+    int inner_bits = ((r() >> 6) * 62) >> 58;
+    uint64_t next_odd = (r() & ((2ULL << inner_bits) - 1)) | (2ULL << inner_bits) | 1;
+    if (product * next_odd > two_to_64) {
+      next_odd = (uint64_t)(two_to_64 / product + 1) | 1;
+      last = true;
+    }
+    configuration.push_back(next_odd);
+    product *= next_odd;
+
+    inner_bits = ((r() >> 6) * 62) >> 58;
+    next_odd = (r() & ((2ULL << inner_bits) - 1)) | (2ULL << inner_bits) | 1;
+    interference.push_back(next_odd);
+  }
+  interference[0] = 1;
+  for (auto &v : ws.sampled) {
+    v.clear();
+    v.reserve((max_iterations >> sample_bits) * 9 / 8);
+  }
+  auto sample = [&](int variant, uint128_t composite) {
+    uint64_t s = mix64((uint64_t)composite ^ mix64((uint64_t)(composite >> 64)));
+    if (sample_bits == 0 || (s >> (64 - sample_bits)) == 0) {
+      ws.sampled[variant].push_back(composite);
+    }
+  };
+  for (uint64_t iterations = 0; iterations < max_iterations; iterations++) {
+    uint64_t cur = mix64(start_val);
+    uint128_t composite = 0;
+    uint64_t cur_xtra = cur;
+    uint128_t composite_xtra = 0;
+    uint64_t cur_inter = cur;
+    uint128_t composite_inter = 0;
+    uint64_t cur_inter_xtra = cur;
+    uint128_t composite_inter_xtra = 0;
+    for (unsigned i = 0; i < configuration.size(); i++) {
+      uint64_t p = configuration[i];
+
+      uint64_t upper = ((uint128_t)cur * p) >> 64;
+      composite = composite * p + upper;
+      cur = cur * p;
+
+      upper = ((uint128_t)cur_xtra * p) >> 64;
+      composite_xtra = composite_xtra * p + upper;
+      cur_xtra = cur_xtra * p + upper;
+
+      cur_inter *= interference[i];
+      upper = ((uint128_t)cur_inter * p) >> 64;
+      composite_inter = composite_inter * p + upper;
+      cur_inter = cur_inter * p;
+
+      cur_inter_xtra *= interference[i];
+      upper = ((uint128_t)cur_inter_xtra * p) >> 64;
+      composite_inter_xtra = composite_inter_xtra * p + upper;
+      cur_inter_xtra = cur_inter_xtra * p + upper;
+    }
+    sample(0, composite);
+    sample(1, composite_xtra);
+    sample(2, composite_inter);
+    sample(3, composite_inter_xtra);
+
+    start_val += start_val_incr; // overflow ok
+  }
+
+  int64_t est[4];
+  for (int i = 0; i < 4; i++) {
+    est[i] = (int64_t)count_repeats(ws.sampled[i]) << sample_bits;
+  }
+  stats.add(configuration.size(), est[0], est[1], est[2], est[3]);
+
+  out << "Various64#" << testno << ": ";
+  for (unsigned i = 0; i < configuration.size(); i++) {
+    out << "(" << interference[i] << "*)"
+        << configuration[i];
+    if (i + 1 < configuration.size()) {
+      out << "*";
+    } else {
+      out << " ";
+    }
+  }
+  double expected = (double)max_iterations * (double)max_iterations /
+                    (2.0 * (double)product);
+  out << "(" << (double)product / (double)two_to_64 << ") 2**"
+      << log2_iterations << " sampled 1/2**" << sample_bits
+      << " expect " << expected
+      << " -> ~" << est[0] << " coll, ~"
+      << est[1] << " xtra, ~"
+      << est[2] << " inter, ~"
+      << est[3] << " inter_xtra"
+      << '\n';
+}
+
+static void run_test64(std::mt19937_64 &r, int testno, int log2_iterations,
+                       Workspace &ws, std::ostream &out, Stats &various_stats) {
+  uint64_t start_val = r();
+  uint64_t start_val_incr = r() | 1;
+  various64_test(r, testno, start_val, start_val_incr, log2_iterations, ws,
+                 out, various_stats);
+}
+
+static void run_test(std::mt19937_64 &r, int testno, Workspace &ws,
+                     std::ostream &out, Stats &various_stats,
+                     Stats &same_stats) {
+  uint32_t start_val = r();
+  uint32_t start_val_incr = r() | 1;
+  various_test(r, testno, start_val, start_val_incr, ws, out, various_stats);
+  same_test(r, testno, start_val, start_val_incr, ws, out, same_stats);
+}
+
+static void print_summary(int num_tests, int seed, int word_bits,
+                          const Stats &various_stats, const Stats &same_stats) {
+  static const char *const various_names[] = {"coll", "xtra", "inter", "inter_xtra"};
+  static const char *const same_names[] = {"coll", "xtra"};
+  std::cout << "Summary of " << num_tests << " tests, seed " << seed << ":\n";
+  various_stats.print(std::cout, word_bits == 64 ? "Various64" : "Various",
+                      "ranges", various_names, 4);
+  same_stats.print(std::cout, "Same", "power", same_names, 2);
+}
+
+// Runs tests 0 .. num_tests-1 on num_threads threads. Each test gets its own
+// generator seeded from (seed, testno), so output does not depend on the
+// number of threads (but differs from the single-threaded mode, which uses
+// one generator for all tests). Per-test output is printed in test order,
+// followed by collision statistics merged across tests. word_bits 64 runs
+// only the (sampled) Various64# test, with 2**log2_iterations iterations.
+static void run_parallel(int seed, int num_threads, int num_tests,
+                         int word_bits, int log2_iterations) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::string> outputs(num_tests);
+  std::vector<bool> done(num_tests);
+  Stats various_stats;
+  Stats same_stats;
+  std::atomic<int> next_testno{0};
+
+  auto worker = [&]() {
+    Workspace ws;
+    Stats my_various_stats;
+    Stats my_same_stats;
+    for (;;) {
+      int testno = next_testno++;
+      if (testno >= num_tests) {
+        break;
+      }
+      std::mt19937_64 r(hash(testno, seed));
+      std::ostringstream out;
+      if (word_bits == 64) {
+        run_test64(r, testno, log2_iterations, ws, out, my_various_stats);
+      } else {
+        run_test(r, testno, ws, out, my_various_stats, my_same_stats);
       }
+      std::lock_guard<std::mutex> lock(mutex);
+      outputs[testno] = out.str();
+      done[testno] = true;
+      cv.notify_one();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    various_stats.merge(my_various_stats);
+    same_stats.merge(my_same_stats);
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (int testno = 0; testno < num_tests; testno++) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() { return done[testno]; });
+    std::cout << outputs[testno] << std::flush;
+    outputs[testno].clear();
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  print_summary(num_tests, seed, word_bits, various_stats, same_stats);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cerr << "Not enough arguments" << std::endl;
+    return 2;
+  }
+  int seed = std::atoi(argv[1]);
+
+  if (argc >= 4) {
+    int num_threads = std::atoi(argv[2]);
+    int num_tests = std::atoi(argv[3]);
+    int word_bits = argc >= 5 ? std::atoi(argv[4]) : 32;
+    int log2_iterations = argc >= 6 ? std::atoi(argv[5]) : 26;
+    if (num_threads < 1 || num_tests < 1) {
+      std::cerr << "Bad thread or test count" << std::endl;
+      return 2;
+    }
+    if (word_bits != 32 && word_bits != 64) {
+      std::cerr << "Word bits must be 32 or 64" << std::endl;
+      return 2;
+    }
+    if (log2_iterations < 1 || log2_iterations > 62) {
+      std::cerr << "Bad log2 iterations" << std::endl;
+      return 2;
+    }
+    run_parallel(seed, num_threads, num_tests, word_bits, log2_iterations);
+    return 0;
+  }
 
-      std::cout << "Same#" << testno << ": "
-                << multiplicand << "**" << power << " "
-                << "(" << log2(product) << " bits vs. " << log2(rep) << ")"
-                << " -> " << collisions << " coll, "
-                << collisions_xtra << " xtra" << std::endl;
+  std::mt19937_64 r(seed);
+  Workspace ws;
+  Stats various_stats;
+  Stats same_stats;
+  // Runs until interrupted, with a running summary every 100 tests
+  for (int testno = 0; ; testno++) {
+    run_test(r, testno, ws, std::cout, various_stats, same_stats);
+    if ((testno + 1) % 100 == 0) {
+      print_summary(testno + 1, seed, 32, various_stats, same_stats);
     }
+    std::cout << std::flush;
   }
   return 0;
 }
@@ -286,4 +646,10 @@ $ ./build.sh
 ...
 $ ./entropy.out $RANDOM
 ...
+$ # Parallel: 8 threads, 1000 tests (needs up to ~4GB memory per thread)
+$ ./entropy.out $RANDOM 8 1000
+...
+$ # 64-bit worm, 2**30 iterations per test (sampled, ~256MB per thread)
+$ ./entropy.out $RANDOM 8 100 64 30
+...
 */